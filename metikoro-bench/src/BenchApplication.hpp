@@ -0,0 +1,359 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Benchmark.hpp"
+
+#include "Error.hpp"
+#include "GameState.hpp"
+#include "StateCorpus.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+/// Measure the primitives of the library that dominate the profiles of the simulation.
+///
+/// The input for all benchmarks is prepared from a corpus of states, before anything is measured. Each
+/// benchmark cycles over its prepared input, so the measured time is an average over typical game states.
+/// The results can be written as text, CSV or JSON, to compare different builds.
+///
+class BenchApplication final {
+    constexpr static auto introLine = "MetiKoro Bench - Version 1.0";
+
+public:
+    BenchApplication() = default;
+
+public:
+    auto run(const int argc, const char *argv[]) -> int {
+        try {
+            if (not parseArguments(argc, argv)) {
+                return 0;
+            }
+            registerBenchmarks();
+            if (_listOnly) {
+                for (const auto &benchmark : _benchmarks) {
+                    std::cout << benchmark.name() << "\n";
+                }
+                return 0;
+            }
+            prepareInput();
+            runBenchmarks();
+            writeResults();
+            return 0;
+        } catch (const Error &error) {
+            std::cerr << std::format("*** ERROR: {} ***\n\n", error.what());
+            displayHelp();
+            return 1;
+        }
+    }
+
+private:
+    enum class Format {
+        Text,
+        Csv,
+        Json,
+    };
+
+    /// The arguments for one orb move.
+    ///
+    struct OrbMove {
+        OrbPositions orbPositions; ///< The orb positions before the move.
+        Position from; ///< The position of the moved orb.
+        Position to; ///< The free target position.
+    };
+
+    /// The arguments for one connection lookup.
+    ///
+    struct Connection {
+        Field field; ///< The field.
+        Anchor anchor; ///< The anchor to start from.
+    };
+
+    static void displayHelp() {
+        std::cout << introLine << "\n";
+        std::cout << "Usage: metikoro-bench [<options>]\n\n";
+        std::cout << "Options:\n";
+        std::cout << "  --help, -h                    Display this help message\n";
+        std::cout << "  --list                        List the names of all benchmarks.\n";
+        std::cout << "  --filter=<text>               Only run benchmarks whose name contains this text.\n";
+        std::cout << "  --corpus=<file>               Load the states from a file, one `toData()` string per line.\n";
+        std::cout << "  --random=<count>              Generate states from random playouts (default: 200 states).\n";
+        std::cout << "  --seed=<number>               The seed for the random playouts (default: 1).\n";
+        std::cout << "  --warm-up=<ms>                The warm-up time for each benchmark (default: 100).\n";
+        std::cout << "  --sample-time=<ms>            The target duration of one sample (default: 10).\n";
+        std::cout << "  --repetitions=<count>         The number of samples for each benchmark (default: 30).\n";
+        std::cout << "  --format=<text|csv|json>      The format of the results (default: text).\n";
+        std::cout << "  --output=<file>               Write the results into a file, instead of the console.\n";
+    }
+
+    auto parseArguments(const int argc, const char *argv[]) -> bool {
+        for (const std::string_view arg : std::span{argv + 1, static_cast<std::size_t>(argc - 1)}) {
+            const auto value = [&arg]() -> std::string {
+                return std::string{arg.substr(arg.find_first_of('=') + 1)};
+            };
+            if (arg == "--help" or arg == "-h") {
+                displayHelp();
+                return false;
+            }
+            if (arg == "--list") {
+                _listOnly = true;
+            } else if (arg.starts_with("--filter=")) {
+                _filter = value();
+            } else if (arg.starts_with("--corpus=")) {
+                _corpusPath = value();
+            } else if (arg.starts_with("--random=")) {
+                _randomCount = std::max(std::stoull(value()), 1ULL);
+            } else if (arg.starts_with("--seed=")) {
+                _seed = std::stoull(value());
+            } else if (arg.starts_with("--warm-up=")) {
+                _settings.warmUpTime = std::chrono::milliseconds{std::stoull(value())};
+            } else if (arg.starts_with("--sample-time=")) {
+                _settings.sampleTime = std::chrono::milliseconds{std::max(std::stoull(value()), 1ULL)};
+            } else if (arg.starts_with("--repetitions=")) {
+                _settings.repetitions = std::max(std::stoull(value()), 1ULL);
+            } else if (arg.starts_with("--format=")) {
+                _format = formatFromName(value());
+            } else if (arg.starts_with("--output=")) {
+                _outputPath = value();
+            } else {
+                throw Error{"Unknown option: " + std::string{arg}};
+            }
+        }
+        return true;
+    }
+
+    /// Prepare the input for all benchmarks, from the corpus.
+    ///
+    /// The benchmarks are registered before, but only access the input while they run.
+    ///
+    void prepareInput() {
+        if (not _corpusPath.empty()) {
+            std::ifstream input{_corpusPath};
+            if (not input) {
+                throw Error{"Could not open the file: " + _corpusPath};
+            }
+            _corpus = StateCorpus::fromStream(input);
+        } else {
+            _corpus = StateCorpus::fromRandomPlayouts(_randomCount, _seed);
+        }
+        if (_corpus.empty()) {
+            throw Error{"There are no states in the corpus."};
+        }
+        for (const auto &state : _corpus) {
+            _stateData.push_back(state.toData());
+            if (auto orbMove = findOrbMove(state.orbPositions()); orbMove.has_value()) {
+                _orbMoves.push_back(*orbMove);
+            }
+            for (auto y = 0U; y < setup::boardSize; ++y) {
+                for (auto x = 0U; x < setup::boardSize; ++x) {
+                    const auto field = state.board().field(Position{static_cast<Length>(x), static_cast<Length>(y)});
+                    if (field.empty()) {
+                        continue;
+                    }
+                    for (const auto anchor : Anchor::all()) {
+                        _connections.push_back(Connection{field, anchor});
+                    }
+                }
+            }
+        }
+        if (_orbMoves.empty() or _connections.empty()) {
+            throw Error{"The corpus does not contain orbs or stones on the board."};
+        }
+    }
+
+    /// Find a valid orb move for the benchmark, from the first orb in the game to the first free position.
+    ///
+    [[nodiscard]] static auto findOrbMove(const OrbPositions &orbPositions) noexcept -> std::optional<OrbMove> {
+        const auto orb = std::ranges::find_if(orbPositions.positions(), [](const OrbPosition &op) {
+            return not op.position.isInvalid();
+        });
+        if (orb == orbPositions.positions().end()) {
+            return std::nullopt;
+        }
+        for (auto y = 0U; y < setup::boardSize; ++y) {
+            for (auto x = 0U; x < setup::boardSize; ++x) {
+                const auto position = Position{static_cast<Length>(x), static_cast<Length>(y)};
+                if (not orbPositions.isOrbAt(position)) {
+                    return OrbMove{orbPositions, orb->position, position};
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    void registerBenchmarks() {
+        add("GameState::rotated", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).rotated(Rotation::Clockwise90));
+        });
+        add("GameState::rotatedToPlayer", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).rotatedToPlayer(Player{static_cast<uint8_t>(1U + index % 3U)}));
+        });
+        add("std::hash<GameState>", [this](const std::size_t index) {
+            doNotOptimize(std::hash<GameState>{}(stateAt(index)));
+        });
+        add("GameState::toData", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).toData());
+        });
+        add("GameState::fromData", [this](const std::size_t index) {
+            doNotOptimize(GameState::fromData(_stateData[index % _stateData.size()]));
+        });
+        add("Board::allPlaceOneActionPositions", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).board().allPlaceOneActionPositions());
+        });
+        add("Board::placeTwoActionPositionPairs", [this](const std::size_t index) {
+            // The pairs are no longer stored in a list, but visited from the list of single positions.
+            const auto positions = stateAt(index).board().allPlaceOneActionPositions();
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                for (std::size_t j = i + 1; j < positions.size(); ++j) {
+                    doNotOptimize(std::pair{positions[i], positions[j]});
+                    count += 1;
+                }
+            }
+            doNotOptimize(count);
+        });
+        add("StonePool::uniqueStoneQuads", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).actionPools().active().uniqueStoneQuads());
+        });
+        add("ResourcePool::allActionTwoExtraDraws", [this](const std::size_t index) {
+            doNotOptimize(stateAt(index).resourcePool().allActionTwoExtraDraws());
+        });
+        add("OrbPositions::moveOrb", [this](const std::size_t index) {
+            const auto &orbMove = _orbMoves[index % _orbMoves.size()];
+            auto orbPositions = orbMove.orbPositions;
+            orbPositions.moveOrb(orbMove.from, orbMove.to);
+            doNotOptimize(orbPositions);
+        });
+        add("Field::connectionsFrom", [this](const std::size_t index) {
+            const auto &connection = _connections[index % _connections.size()];
+            doNotOptimize(connection.field.connectionsFrom(connection.anchor));
+        });
+    }
+
+    [[nodiscard]] auto stateAt(const std::size_t index) const noexcept -> const GameState& {
+        return _corpus.states()[index % _corpus.size()];
+    }
+
+    template<typename Fn>
+    void add(std::string name, Fn operationFn) {
+        if (not _filter.empty() and name.find(_filter) == std::string::npos) {
+            return;
+        }
+        _benchmarks.emplace_back(std::move(name), std::move(operationFn));
+    }
+
+    void runBenchmarks() {
+        if (_benchmarks.empty()) {
+            throw Error{"No benchmark matches the filter: " + _filter};
+        }
+        if (_format == Format::Text or not _outputPath.empty()) {
+            std::cout << introLine << "\n";
+            std::cout << std::format("> States: {}, repetitions: {}, sample time: {} ms\n",
+                _corpus.size(), _settings.repetitions, _settings.sampleTime.count());
+        }
+        for (const auto &benchmark : _benchmarks) {
+            _results.push_back(benchmark.run(_settings));
+            if (_format == Format::Text and _outputPath.empty()) {
+                std::cout << toText(_results.back());
+            }
+        }
+    }
+
+    void writeResults() const {
+        if (_format == Format::Text and _outputPath.empty()) {
+            return;
+        }
+        std::ostringstream text;
+        switch (_format) {
+        case Format::Text:
+            for (const auto &result : _results) {
+                text << toText(result);
+            }
+            break;
+        case Format::Csv:
+            text << "name,operations,min,p50,p90,p99,max,mean,stddev\n";
+            for (const auto &result : _results) {
+                text << std::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n", result.name,
+                    result.operationsPerSample, result.minimum(), result.percentile(50), result.percentile(90),
+                    result.percentile(99), result.maximum(), result.mean(), result.standardDeviation());
+            }
+            break;
+        case Format::Json:
+            text << "{\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+            for (std::size_t i = 0; i < _results.size(); ++i) {
+                const auto &result = _results[i];
+                text << std::format(
+                    "    {{\"name\": \"{}\", \"operations\": {}, \"min\": {:.3f}, \"p50\": {:.3f}, \"p90\": {:.3f}, "
+                    "\"p99\": {:.3f}, \"max\": {:.3f}, \"mean\": {:.3f}, \"stddev\": {:.3f}}}{}\n",
+                    result.name, result.operationsPerSample, result.minimum(), result.percentile(50),
+                    result.percentile(90), result.percentile(99), result.maximum(), result.mean(),
+                    result.standardDeviation(), i + 1 < _results.size() ? "," : "");
+            }
+            text << "  ]\n}\n";
+            break;
+        }
+        if (_outputPath.empty()) {
+            std::cout << text.str();
+            return;
+        }
+        std::ofstream output{_outputPath};
+        if (not output) {
+            throw Error{"Could not open the output file for writing: " + _outputPath};
+        }
+        output << text.str();
+        std::cout << std::format("> Results written to: {}\n", _outputPath);
+    }
+
+    [[nodiscard]] static auto toText(const BenchmarkResult &result) -> std::string {
+        return std::format("  {:<40} min {:>10.2f}  p50 {:>10.2f}  p90 {:>10.2f}  p99 {:>10.2f}  ns/op (±{:.1f})\n",
+            result.name, result.minimum(), result.percentile(50), result.percentile(90), result.percentile(99),
+            result.standardDeviation());
+    }
+
+    [[nodiscard]] static auto formatFromName(const std::string_view name) -> Format {
+        if (name == "text") {
+            return Format::Text;
+        }
+        if (name == "csv") {
+            return Format::Csv;
+        }
+        if (name == "json") {
+            return Format::Json;
+        }
+        throw Error{"Unknown format: " + std::string{name}};
+    }
+
+private:
+    // configuration
+    std::string _filter; ///< Only run benchmarks containing this text, or empty for all.
+    std::string _corpusPath; ///< The corpus file, or empty for random playouts.
+    std::string _outputPath; ///< The output file, or empty for the console.
+    std::size_t _randomCount{200}; ///< The number of states from random playouts.
+    uint64_t _seed{1}; ///< The seed for random playouts.
+    BenchmarkSettings _settings; ///< The timing settings.
+    Format _format{Format::Text}; ///< The format of the results.
+    bool _listOnly{false}; ///< Only list the benchmarks.
+
+    // input
+    StateCorpus _corpus; ///< The states used as input.
+    std::vector<std::string> _stateData; ///< The text form of all states.
+    std::vector<OrbMove> _orbMoves; ///< One orb move for each state with an orb.
+    std::vector<Connection> _connections; ///< All anchors of all non-empty fields.
+
+    // working
+    std::vector<Benchmark> _benchmarks;
+    std::vector<BenchmarkResult> _results;
+};
+
@@ -0,0 +1,135 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/// Prevent the compiler from removing a computation, whose result is not used otherwise.
+///
+template<typename T>
+inline void doNotOptimize(const T &value) noexcept {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+/// The timing settings for all benchmarks.
+///
+struct BenchmarkSettings {
+    std::chrono::milliseconds warmUpTime{100}; ///< The time to run a benchmark before measuring.
+    std::chrono::milliseconds sampleTime{10}; ///< The target duration of one sample.
+    std::size_t repetitions{30}; ///< The number of samples.
+};
+
+
+/// The measured time of one benchmark.
+///
+/// All times are in nanoseconds per operation.
+///
+struct BenchmarkResult {
+    std::string name; ///< The name of the benchmark.
+    std::size_t operationsPerSample{0}; ///< The number of operations in one sample.
+    std::vector<double> samples; ///< The time of each sample, sorted ascending.
+
+    [[nodiscard]] auto minimum() const noexcept -> double { return samples.front(); }
+    [[nodiscard]] auto maximum() const noexcept -> double { return samples.back(); }
+    [[nodiscard]] auto mean() const noexcept -> double {
+        return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    }
+    [[nodiscard]] auto standardDeviation() const noexcept -> double {
+        const auto mean = this->mean();
+        const auto sum = std::accumulate(samples.begin(), samples.end(), 0.0, [mean](double sum, double sample) {
+            return sum + (sample - mean) * (sample - mean);
+        });
+        return std::sqrt(sum / static_cast<double>(samples.size()));
+    }
+
+    /// Get a percentile, using the nearest-rank method.
+    ///
+    /// @param percent The percentile, from 0 to 100.
+    ///
+    [[nodiscard]] auto percentile(const double percent) const noexcept -> double {
+        const auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * static_cast<double>(samples.size())));
+        return samples[std::clamp(rank, std::size_t{1}, samples.size()) - 1];
+    }
+};
+
+
+/// One microbenchmark.
+///
+/// The measured function is called with a running operation index, so it can iterate over prepared input.
+/// It is called in batches, in a loop where it can be inlined. The number of operations per sample is
+/// calibrated during the warm-up, so each sample runs for about the configured sample time. This keeps the
+/// overhead of reading the clock out of the measurement.
+///
+class Benchmark {
+public:
+    using BatchFn = std::function<void(std::size_t firstIndex, std::size_t count)>;
+
+public:
+    /// Create a new benchmark.
+    ///
+    /// @param name The name of the benchmark.
+    /// @param operationFn The measured operation, called with the operation index.
+    ///
+    template<typename Fn>
+    Benchmark(std::string name, Fn operationFn) noexcept
+        : _name{std::move(name)},
+          _batchFn{[fn = std::move(operationFn)](const std::size_t firstIndex, const std::size_t count) {
+              for (std::size_t i = 0; i < count; ++i) {
+                  fn(firstIndex + i);
+              }
+          }} {
+    }
+
+public:
+    [[nodiscard]] auto name() const noexcept -> const std::string& { return _name; }
+
+    /// Warm up, calibrate and measure this benchmark.
+    ///
+    [[nodiscard]] auto run(const BenchmarkSettings &settings) const -> BenchmarkResult {
+        using namespace std::chrono;
+        std::size_t operationIndex = 0;
+        auto runBatch = [&](const std::size_t count) -> steady_clock::duration {
+            const auto start = steady_clock::now();
+            _batchFn(operationIndex, count);
+            operationIndex += count;
+            return steady_clock::now() - start;
+        };
+        // Warm up, while doubling the batch size until one batch takes the sample time.
+        std::size_t batchSize = 1;
+        const auto warmUpEnd = steady_clock::now() + settings.warmUpTime;
+        while (true) {
+            const auto duration = runBatch(batchSize);
+            if (duration < settings.sampleTime) {
+                batchSize *= 2;
+            } else if (steady_clock::now() >= warmUpEnd) {
+                break;
+            }
+        }
+        BenchmarkResult result;
+        result.name = _name;
+        result.operationsPerSample = batchSize;
+        result.samples.reserve(settings.repetitions);
+        for (std::size_t i = 0; i < settings.repetitions; ++i) {
+            const auto duration = duration_cast<nanoseconds>(runBatch(batchSize));
+            result.samples.push_back(static_cast<double>(duration.count()) / static_cast<double>(batchSize));
+        }
+        std::ranges::sort(result.samples);
+        return result;
+    }
+
+private:
+    std::string _name; ///< The name of the benchmark.
+    BatchFn _batchFn; ///< Runs a batch of the measured operation.
+};
+
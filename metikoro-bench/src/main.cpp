@@ -0,0 +1,12 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include "BenchApplication.hpp"
+
+
+auto main(int argc, const char *argv[]) -> int {
+    BenchApplication app;
+    return app.run(argc, argv);
+}
+
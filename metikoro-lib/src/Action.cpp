@@ -7,31 +7,32 @@
 #include "GameState.hpp"
 
 
-void Action::applyTo(GameState &state) const {
+void Action::applyTo(GameState &state, const Player perspective) const {
     switch (type()) {
-    case PlaceStone: applyPlaceAction(state); break;
-    case ReplaceStone: applyReplaceAction(state); break;
-    case RotateStone: applyRotateAction(state); break;
-    case DrawStone: applyDrawAction(state); break;
+    case PlaceStone: applyPlaceAction(state, perspective); break;
+    case ReplaceStone: applyReplaceAction(state, perspective); break;
+    case RotateStone: applyRotateAction(state, perspective); break;
+    case DrawStone: applyDrawAction(state, perspective); break;
     default: break;
     }
 }
 
 
-void Action::applyPlaceAction(GameState &state) const {
-    if (not state.actionPools().active().hasStone(actionStone())) {
+void Action::applyPlaceAction(GameState &state, const Player perspective) const {
+    auto &pool = state.actionPools()[perspective];
+    if (not pool.hasStone(actionStone())) {
         throw Error("Tried to place a stone that is not in the action pool.");
     }
-    if (not state.board().canPlayerPlaceStone(position())) {
+    if (not state.board().canPlayerPlaceStone(position(), perspective)) {
         throw Error("Tried to place a stone on a position where a stone is already placed.");
     }
     state.board().setField(position(), actionStone(), orientation());
-    state.actionPools().active().take(actionStone());
+    pool.take(actionStone());
 }
 
 
-void Action::applyReplaceAction(GameState &state) const {
-    auto &pool = state.actionPools().active();
+void Action::applyReplaceAction(GameState &state, const Player perspective) const {
+    auto &pool = state.actionPools()[perspective];
     if (pool.stoneCount() < 2) {
         throw Error("Replace action requires at least two stones in the action pool.");
     }
@@ -49,8 +50,8 @@ void Action::applyReplaceAction(GameState &state) const {
 }
 
 
-void Action::applyRotateAction(GameState &state) const {
-    auto &pool = state.actionPools().active();
+void Action::applyRotateAction(GameState &state, const Player perspective) const {
+    auto &pool = state.actionPools()[perspective];
     if (pool.empty()) {
         throw Error("Rotate action requires at least one stone in the action pool.");
     }
@@ -69,8 +70,8 @@ void Action::applyRotateAction(GameState &state) const {
 }
 
 
-void Action::applyDrawAction(GameState &state) const {
-    auto &pool = state.actionPools().active();
+void Action::applyDrawAction(GameState &state, const Player perspective) const {
+    auto &pool = state.actionPools()[perspective];
     if (pool.full()) {
         throw Error("Draw action requires at least one free slot in the action pool.");
     }
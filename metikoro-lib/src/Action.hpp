@@ -3,7 +3,10 @@
 #pragma once
 
 
+#include "Player.hpp"
 #include "Position.hpp"
+#include "Rotation.hpp"
+#include "Setup.hpp"
 #include "Stone.hpp"
 #include "Utilities.hpp"
 
@@ -107,9 +110,32 @@ public: // attributes
 
     /// Apply this action to the given state.
     ///
+    /// @param state The state to modify.
+    /// @param perspective The player executing the action. Player 0, if the state is rotated for the active player.
     /// @throws Error in case this action is not valid for this state.
     ///
-    void applyTo(GameState &state) const;
+    void applyTo(GameState &state, Player perspective = Player{0}) const;
+
+    /// Create a rotated version of this action, matching a rotated state.
+    ///
+    [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> Action {
+        switch (type()) {
+        case PlaceStone:
+        case ReplaceStone:
+            return Action{
+                type(),
+                actionStone(),
+                droppedStone(),
+                actionStone().normalizedOrientation(orientation() + rotation),
+                position().rotated(rotation, setup::boardSize)};
+        case RotateStone:
+            return Action{
+                type(), actionStone(), droppedStone(), orientation() + rotation,
+                position().rotated(rotation, setup::boardSize)};
+        default:
+            return *this;
+        }
+    }
 
 public: // serialization
     [[nodiscard]] constexpr static auto dataSize() noexcept -> std::size_t {
@@ -166,10 +192,10 @@ public:
     }
 
 private:
-    void applyPlaceAction(GameState &state) const;
-    void applyReplaceAction(GameState &state) const;
-    void applyRotateAction(GameState &state) const;
-    void applyDrawAction(GameState &state) const;
+    void applyPlaceAction(GameState &state, Player perspective) const;
+    void applyReplaceAction(GameState &state, Player perspective) const;
+    void applyRotateAction(GameState &state, Player perspective) const;
+    void applyDrawAction(GameState &state, Player perspective) const;
 
 private:
     Data _data; ///< The bitfield with the action values.
@@ -5,80 +5,194 @@
 
 #include "ActionSequences.hpp"
 #include "GameState.hpp"
+#include "Utilities.hpp"
 
+#include <algorithm>
+#include <array>
+#include <numeric>
 
+
+/// Generates all valid action sequences for a state.
+///
+/// All callbacks are template parameters, so the visitors are called directly and can be inlined. The
+/// positions and stone combinations are collected in inline lists, so the generation does not allocate
+/// memory, unless the visitor does.
+///
+/// In the canonical mode, sequences that only differ in the order of two dropped stones are generated once.
+/// The dropped stones end up in the resource pool, and the action pool is kept sorted, so the resulting state
+/// does not depend on this order. Placed stones are already combined with ordered position pairs, so all
+/// other sequences lead to distinct states.
+///
 class ActionGenerator {
-    using AddActionSeqFn = std::function<void(const ActionSequence&)>;
+    using FieldPositions = Board::FieldPositions;
+    using UniqueStones = ActionPool::UniqueStones;
+    using UniqueStonePairs = ActionPool::UniqueStonePairs;
+    using UniqueStoneQuads = ActionPool::UniqueStoneQuads;
 
 public:
-    explicit ActionGenerator(const GameState &state) : _state(state) {}
+    /// Create a new action generator.
+    ///
+    /// @param state The state to generate the actions for. It is stored as reference, make sure it exists
+    ///     while the generator is used!
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are generated.
+    ///
+    explicit ActionGenerator(
+        const GameState &state,
+        const Player perspective = Player{0},
+        const ActionSequences::Mode mode = ActionSequences::Mode::All)
+        : _state(state), _perspective{perspective}, _mode{mode} {
+    }
 
 public:
+    /// Generate all action sequences in a single pass.
+    ///
+    /// The sequences are collected in a buffer that is kept per thread and reused for every call, so the
+    /// only allocation is the one for the result, with its final size.
+    ///
     [[nodiscard]] auto all() const noexcept -> ActionSequences {
+        thread_local ActionSequences::Actions buffer;
+        buffer.clear();
+        forEachAction([](const ActionSequence &actionSeq) { buffer.push_back(actionSeq); });
         ActionSequences actions;
-        actions.reserve(countAllActions());
-        addAllActions([&actions](const ActionSequence &actionSeq) {
+        actions.reserve(buffer.size());
+        for (const auto &actionSeq : buffer) {
             actions.add(actionSeq);
-        });
+        }
         return actions;
     }
 
+    /// Call a function for each action sequence.
+    ///
+    /// @param fn The visitor, called with a `const ActionSequence&`. If it returns `bool`, `false` stops
+    ///     the iteration.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    auto forEachAction(Fn &&fn) const noexcept -> bool {
+        const auto stoneCount = activePool().stoneCount();
+        return forEachPlace(fn, stoneCount)
+            and forEachReplace(fn, stoneCount)
+            and forEachRotate(fn, stoneCount)
+            and forEachExtraDraw(fn);
+    }
+
+public: // counting and unranking
+    /// The families of action sequences, in the order they are generated.
+    ///
+    enum class Family : uint8_t {
+        PlaceOne,
+        PlaceTwo,
+        ReplaceOne,
+        ReplaceTwo,
+        RotateOne,
+        RotateTwo,
+        ExtraDrawOne,
+        ExtraDrawTwo,
+
+        EnumCount, // must be last element
+    };
+    static constexpr std::size_t familyCount = static_cast<std::size_t>(Family::EnumCount);
+    using FamilyCounts = std::array<std::size_t, familyCount>;
+    struct Census;
+
+    /// Count the action sequences of each family, without generating them.
+    ///
+    /// The counts are calculated from the position lists, the stone combinations and the number of valid
+    /// orientations for each position and stone.
+    ///
+    [[nodiscard]] auto countFamilies() const noexcept -> FamilyCounts {
+        return Census{*this}.counts;
+    }
+
+    /// Count all action sequences, without generating them.
+    ///
     [[nodiscard]] auto countAllActions() const noexcept -> std::size_t {
-        std::size_t count = 0;
-        addAllActions([&count](const ActionSequence&) { ++count; });
-        return count;
+        return Census{*this}.total();
     }
 
-    void addAllActions(const AddActionSeqFn &addFn) const noexcept {
-        const auto stoneCount = actionPools().active().stoneCount();
-        addActionsPlace(addFn, stoneCount);
-        addActionsReplace(addFn, stoneCount);
-        addActionsRotate(addFn, stoneCount);
-        addActionsExtraDraw(addFn);
+    /// Create the census of the current state, to count and unrank its action sequences more than once.
+    ///
+    /// Building the census is the expensive part of `countAllActions()` and `actionAt()`. A caller that counts
+    /// and selects an action of the same state builds it once, and passes it to `actionAt(census, index)`.
+    ///
+    [[nodiscard]] auto census() const noexcept -> Census {
+        return Census{*this};
     }
 
-    static void forAllForPlace(
-        const PositionList &positions,
-        const StoneList &stones,
-        const std::function<void(Position, Stone, Orientation)> &fn) noexcept {
+    /// Create the action sequence at the given index, without generating the ones before it.
+    ///
+    /// The index follows the order of `all()`, so `actionAt(i)` returns the same sequence as
+    /// `all().actions().at(i)`. Together with `countAllActions()`, this samples a uniform random action.
+    ///
+    /// @param index The index of the action sequence.
+    /// @throws Error if the index is out of range.
+    ///
+    [[nodiscard]] auto actionAt(const std::size_t index) const -> ActionSequence {
+        return actionAt(Census{*this}, index);
+    }
 
+    /// Create the action sequence at the given index, using a census of this generator.
+    ///
+    /// @param census The census, created by `census()` of this generator.
+    /// @param index The index of the action sequence.
+    /// @throws Error if the index is out of range.
+    ///
+    [[nodiscard]] static auto actionAt(const Census &census, std::size_t index) -> ActionSequence {
+        for (std::size_t familyIndex = 0; familyIndex < familyCount; ++familyIndex) {
+            const auto count = census.counts[familyIndex];
+            if (index < count) {
+                return census.actionAt(static_cast<Family>(familyIndex), index);
+            }
+            index -= count;
+        }
+        throw Error("ActionGenerator: Action index out of range.");
+    }
+
+    template<typename Fn>
+    static auto forAllForPlace(const FieldPositions &positions, const UniqueStones &stones, Fn &&fn) noexcept -> bool {
         for (const auto position : positions) {
             for (const auto stone : stones) {
                 auto uniqueOrientations = stone.uniqueOrientations();
                 for (const auto orientation : Orientation::all()) {
                     if (uniqueOrientations.contains(orientation)) {
-                        fn(position, stone, orientation);
+                        if (not fn(position, stone, orientation)) {
+                            return false;
+                        }
                     }
                 }
             }
         }
+        return true;
     }
 
-    static void forAllForPlace(
-        const PositionPairList &positionPairs,
-        const StonePairList &stonePairs,
-        const std::function<void(PositionPair, StonePair, OrientationPair)> &fn) noexcept {
-
-        for (const auto &positionPair : positionPairs) {
-            for (const auto &stonePair : stonePairs) {
-                const auto uniqueOrientationsA = stonePair.first.uniqueOrientations();
-                const auto uniqueOrientationsB = stonePair.second.uniqueOrientations();
-                for (const auto orientationA : Orientation::all()) {
-                    for (const auto orientationB : Orientation::all()) {
-                        if (uniqueOrientationsA.contains(orientationA) && uniqueOrientationsB.contains(orientationB)) {
-                            fn(positionPair, stonePair, {orientationA, orientationB});
+    /// Call a function for each pair of positions from the list, combined with each pair of stones.
+    ///
+    template<typename Fn>
+    static auto forAllForPlace(const FieldPositions &positions, const UniqueStonePairs &stonePairs, Fn &&fn) noexcept -> bool {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            for (std::size_t j = i + 1; j < positions.size(); ++j) {
+                const PositionPair positionPair{positions[i], positions[j]};
+                for (const auto &stonePair : stonePairs) {
+                    const auto uniqueOrientationsA = stonePair.first.uniqueOrientations();
+                    const auto uniqueOrientationsB = stonePair.second.uniqueOrientations();
+                    for (const auto orientationA : Orientation::all()) {
+                        for (const auto orientationB : Orientation::all()) {
+                            if (uniqueOrientationsA.contains(orientationA) && uniqueOrientationsB.contains(orientationB)) {
+                                if (not fn(positionPair, stonePair, OrientationPair{orientationA, orientationB})) {
+                                    return false;
+                                }
+                            }
                         }
                     }
                 }
             }
         }
+        return true;
     }
 
-    void forAllForRotation(
-        const PositionList &positions,
-        const StoneList &droppedStones,
-        const std::function<void(Position, Orientation, Stone)> &fn) const noexcept {
-
+    template<typename Fn>
+    auto forAllForRotation(const FieldPositions &positions, const UniqueStones &droppedStones, Fn &&fn) const noexcept -> bool {
         for (const auto position : positions) {
             if (orbPositions().isOrbAt(position)) {
                 continue;
@@ -92,49 +206,54 @@ public:
             for (const auto orientation : Orientation::all()) {
                 if (orientation != currentOrientation and uniqueOrientations.contains(orientation)) {
                     for (const auto droppedStone : droppedStones) {
-                        fn(position, orientation, droppedStone);
+                        if (not fn(position, orientation, droppedStone)) {
+                            return false;
+                        }
                     }
                 }
             }
         }
+        return true;
     }
 
-    void forAllForRotation(
-        const PositionPairList &positionPairs,
-        const StonePairList &droppedStonePairs,
-        const std::function<void(PositionPair, OrientationPair, StonePair)> &fn) const noexcept {
-
-        for (const auto &positionPair : positionPairs) {
-            if (orbPositions().isOrbAt(positionPair.first) || orbPositions().isOrbAt(positionPair.second)) {
-                continue;
-            }
-            const auto &fieldA = board().field(positionPair.first);
-            const auto &fieldB = board().field(positionPair.second);
-            if (not fieldA.canRotate() or not fieldB.canRotate()) {
-                continue;
-            }
-            const auto currentOrientationA = fieldA.orientation();
-            const auto currentOrientationB = fieldB.orientation();
-            const auto uniqueOrientationsA = fieldA.uniqueOrientations();
-            const auto uniqueOrientationsB = fieldB.uniqueOrientations();
-            for (const auto orientationA : Orientation::all()) {
-                for (const auto orientationB : Orientation::all()) {
-                    if (orientationA != currentOrientationA and uniqueOrientationsA.contains(orientationA) and
-                        orientationB != currentOrientationB and uniqueOrientationsB.contains(orientationB)) {
-                        for (const auto &droppedStonePair : droppedStonePairs) {
-                            fn(positionPair, {orientationA, orientationB}, droppedStonePair);
+    /// Call a function for each pair of positions from the list, combined with each rotation of both stones.
+    ///
+    template<typename Fn>
+    auto forAllForRotation(const FieldPositions &positions, const UniqueStonePairs &droppedStonePairs, Fn &&fn) const noexcept -> bool {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            for (std::size_t j = i + 1; j < positions.size(); ++j) {
+                const PositionPair positionPair{positions[i], positions[j]};
+                if (orbPositions().isOrbAt(positionPair.first) || orbPositions().isOrbAt(positionPair.second)) {
+                    continue;
+                }
+                const auto &fieldA = board().field(positionPair.first);
+                const auto &fieldB = board().field(positionPair.second);
+                if (not fieldA.canRotate() or not fieldB.canRotate()) {
+                    continue;
+                }
+                const auto currentOrientationA = fieldA.orientation();
+                const auto currentOrientationB = fieldB.orientation();
+                const auto uniqueOrientationsA = fieldA.uniqueOrientations();
+                const auto uniqueOrientationsB = fieldB.uniqueOrientations();
+                for (const auto orientationA : Orientation::all()) {
+                    for (const auto orientationB : Orientation::all()) {
+                        if (orientationA != currentOrientationA and uniqueOrientationsA.contains(orientationA) and
+                            orientationB != currentOrientationB and uniqueOrientationsB.contains(orientationB)) {
+                            for (const auto &droppedStonePair : droppedStonePairs) {
+                                if (not fn(positionPair, OrientationPair{orientationA, orientationB}, droppedStonePair)) {
+                                    return false;
+                                }
+                            }
                         }
                     }
                 }
             }
         }
+        return true;
     }
 
-    void forAllForReplace(
-        const PositionList &positions,
-        const StonePairList &stonePairs,
-        const std::function<void(Position, StonePair, Orientation)> &fn) const noexcept {
-
+    template<typename Fn>
+    auto forAllForReplace(const FieldPositions &positions, const UniqueStonePairs &stonePairs, Fn &&fn) const noexcept -> bool {
         for (const auto position : positions) {
             if (orbPositions().isOrbAt(position)) {
                 continue;
@@ -143,136 +262,526 @@ public:
                 const auto orientations = stonePair.first.uniqueOrientations();
                 for (const auto orientation : Orientation::all()) {
                     if (orientations.contains(orientation)) {
-                        fn(position, stonePair, orientation);
+                        if (not fn(position, stonePair, orientation)) {
+                            return false;
+                        }
                     }
                 }
             }
         }
+        return true;
     }
 
-    void forAllForReplace(
-        const PositionPairList &positionPairs,
-        const StoneQuadList &stoneQuads,
-        const std::function<void(PositionPair, StonePair, StonePair, OrientationPair)> &fn) const noexcept {
-
-        for (const auto &positionPair : positionPairs) {
-            if (orbPositions().isOrbAt(positionPair.first) || orbPositions().isOrbAt(positionPair.second)) {
-                continue;
-            }
-            for (const auto &stoneQuad : stoneQuads) {
-                const auto orientationsA = std::get<0>(stoneQuad).uniqueOrientations();
-                const auto orientationsB = std::get<1>(stoneQuad).uniqueOrientations();
-                for (const auto orientationA : Orientation::all()) {
-                    for (const auto orientationB : Orientation::all()) {
-                        if (orientationsA.contains(orientationA) and orientationsB.contains(orientationB)) {
-                            fn(
-                                positionPair,
-                                {std::get<0>(stoneQuad), std::get<1>(stoneQuad)},
-                                {std::get<2>(stoneQuad), std::get<3>(stoneQuad)},
-                                {orientationA, orientationB});
+    /// Call a function for each pair of positions from the list, combined with each quad of stones.
+    ///
+    template<typename Fn>
+    auto forAllForReplace(const FieldPositions &positions, const UniqueStoneQuads &stoneQuads, Fn &&fn) const noexcept -> bool {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            for (std::size_t j = i + 1; j < positions.size(); ++j) {
+                const PositionPair positionPair{positions[i], positions[j]};
+                if (orbPositions().isOrbAt(positionPair.first) || orbPositions().isOrbAt(positionPair.second)) {
+                    continue;
+                }
+                for (const auto &stoneQuad : stoneQuads) {
+                    const auto orientationsA = std::get<0>(stoneQuad).uniqueOrientations();
+                    const auto orientationsB = std::get<1>(stoneQuad).uniqueOrientations();
+                    for (const auto orientationA : Orientation::all()) {
+                        for (const auto orientationB : Orientation::all()) {
+                            if (orientationsA.contains(orientationA) and orientationsB.contains(orientationB)) {
+                                if (not fn(
+                                    positionPair,
+                                    StonePair{std::get<0>(stoneQuad), std::get<1>(stoneQuad)},
+                                    StonePair{std::get<2>(stoneQuad), std::get<3>(stoneQuad)},
+                                    OrientationPair{orientationA, orientationB})) {
+                                    return false;
+                                }
+                            }
                         }
                     }
                 }
             }
         }
+        return true;
     }
 
-    void addActionsPlace(const AddActionSeqFn &addFn, const uint8_t stoneCount) const noexcept {
+    template<typename Fn>
+    auto forEachPlace(Fn &fn, const uint8_t stoneCount) const noexcept -> bool {
         if (stoneCount < 1) {
-            return;
+            return true;
         }
-        forAllForPlace(board().allPlaceOneActionPositions(), actionPools().active().uniqueStones(),
+        const auto positions = board().allPlaceOneActionPositions(_perspective);
+        const auto placed = forAllForPlace(positions, activePool().uniqueStones(),
             [&](const Position position, const Stone stone, const Orientation orientation) {
-                addFn(Action::createPlace(position, stone, orientation));
+                return utility::callVisitor(fn, ActionSequence{Action::createPlace(position, stone, orientation)});
             }
         );
-        if (stoneCount < 2) {
-            return;
+        if (not placed or stoneCount < 2) {
+            return placed;
         }
-        forAllForPlace(board().allPlaceTwoActionPositions(), actionPools().active().uniqueStonePairs(),
-            [&](PositionPair pos, StonePair stone, OrientationPair orientationPair) {
-                addFn(std::array{
+        return forAllForPlace(positions, activePool().uniqueStonePairs(),
+            [&](const PositionPair pos, const StonePair stone, const OrientationPair orientationPair) {
+                return utility::callVisitor(fn, ActionSequence{std::array{
                     Action::createPlace(pos.first, stone.first, orientationPair.first),
                     Action::createPlace(pos.second, stone.second, orientationPair.second)
-                });
+                }});
             }
         );
     }
 
-    void addActionsReplace(const AddActionSeqFn &addFn, const uint8_t stoneCount) const noexcept {
+    template<typename Fn>
+    auto forEachReplace(Fn &fn, const uint8_t stoneCount) const noexcept -> bool {
         if (stoneCount < 2) {
-            return;
+            return true;
         }
-        forAllForReplace(board().allReplaceOneActionPositions(), actionPools().active().uniqueStonePairs(),
+        const auto positions = board().allReplaceOneActionPositions();
+        const auto replaced = forAllForReplace(positions, activePool().uniqueStonePairs(),
             [&](const Position position, const StonePair stone, const Orientation orientation) {
-                if (board().canPlayerReplaceStone(position, stone.first, orientation)) {
-                    addFn(Action::createReplace(position, stone.first, orientation, stone.second));
+                if (not board().canPlayerReplaceStone(position, stone.first, orientation)) {
+                    return true;
                 }
+                return utility::callVisitor(fn, ActionSequence{
+                    Action::createReplace(position, stone.first, orientation, stone.second)});
             }
         );
-        if (stoneCount < 4) {
-            return;
-        }
-        forAllForReplace(board().allReplaceTwoActionPositions(), actionPools().active().uniqueStoneQuads(),
-            [&](PositionPair pos, StonePair as, StonePair ds, OrientationPair orientationPair) {
-                if (board().canPlayerReplaceStone(pos.first, as.first, orientationPair.first) && // action possible?
-                    board().canPlayerReplaceStone(pos.second, as.second, orientationPair.second)) {
-                    addFn(std::array{
-                        Action::createReplace(pos.first, as.first, orientationPair.first, ds.first),
-                        Action::createReplace(pos.second, as.second, orientationPair.second, ds.second)
-                    });
+        if (not replaced or stoneCount < 4) {
+            return replaced;
+        }
+        return forAllForReplace(positions, replaceStoneQuads(),
+            [&](const PositionPair pos, const StonePair as, const StonePair ds, const OrientationPair orientationPair) {
+                if (not board().canPlayerReplaceStone(pos.first, as.first, orientationPair.first) or // action possible?
+                    not board().canPlayerReplaceStone(pos.second, as.second, orientationPair.second)) {
+                    return true;
                 }
+                return utility::callVisitor(fn, ActionSequence{std::array{
+                    Action::createReplace(pos.first, as.first, orientationPair.first, ds.first),
+                    Action::createReplace(pos.second, as.second, orientationPair.second, ds.second)
+                }});
             }
         );
     }
 
-    void addActionsRotate(const AddActionSeqFn &addFn, const uint8_t stoneCount) const noexcept {
+    template<typename Fn>
+    auto forEachRotate(Fn &fn, const uint8_t stoneCount) const noexcept -> bool {
         if (stoneCount < 1) {
-            return;
+            return true;
         }
-        forAllForRotation(board().allRotateOneActionPositions(), actionPools().active().uniqueStones(),
+        const auto positions = board().allRotateOneActionPositions();
+        const auto rotated = forAllForRotation(positions, activePool().uniqueStones(),
             [&](const Position position, const Orientation orientation, const Stone droppedStone) {
-                if (board().canPlayerRotateStone(position, orientation)) {
-                    addFn(Action::createRotate(position, orientation, droppedStone));
+                if (not board().canPlayerRotateStone(position, orientation)) {
+                    return true;
                 }
+                return utility::callVisitor(fn, ActionSequence{
+                    Action::createRotate(position, orientation, droppedStone)});
             }
         );
-        if (stoneCount >= 2) {
-            forAllForRotation(board().allRotateTwoActionPositions(), actionPools().active().uniqueStonePairs(),
-                [&](PositionPair pos, OrientationPair orientationPair, StonePair ds) {
-                    if (board().canPlayerRotateStone(pos.first, orientationPair.first) &&
-                        board().canPlayerRotateStone(pos.second, orientationPair.second)) {
-
-                        addFn(std::array{
-                            Action::createRotate(pos.first, orientationPair.first, ds.first),
-                            Action::createRotate(pos.second, orientationPair.second, ds.second)});
-                    }
-                }
-            );
+        if (not rotated or stoneCount < 2) {
+            return rotated;
         }
+        return forAllForRotation(positions, droppedStonePairs(),
+            [&](const PositionPair pos, const OrientationPair orientationPair, const StonePair ds) {
+                if (not board().canPlayerRotateStone(pos.first, orientationPair.first) or
+                    not board().canPlayerRotateStone(pos.second, orientationPair.second)) {
+                    return true;
+                }
+                return utility::callVisitor(fn, ActionSequence{std::array{
+                    Action::createRotate(pos.first, orientationPair.first, ds.first),
+                    Action::createRotate(pos.second, orientationPair.second, ds.second)
+                }});
+            }
+        );
     }
 
-    void addActionsExtraDraw(const AddActionSeqFn &addFn) const noexcept {
-        const auto freeSlots = actionPools().active().freeSlots();
+    template<typename Fn>
+    auto forEachExtraDraw(Fn &fn) const noexcept -> bool {
+        const auto freeSlots = activePool().freeSlots();
         if (freeSlots > 1) { // need at least 2 free slots for extra draw
             for (const auto stone : resourcePool().allActionOneExtraDraw()) {
-                addFn(ActionSequence({Action::createDraw(stone)}));
+                if (not utility::callVisitor(fn, ActionSequence{Action::createDraw(stone)})) {
+                    return false;
+                }
             }
         }
         if (freeSlots > 2) { // need at least 3 free slots for two extra draws
-            for (const auto [stoneA, stoneB] : resourcePool().allActionTwoExtraDraws()) {
-                addFn(ActionSequence({Action::createDraw(stoneA), Action::createDraw(stoneB)}));
+            for (const auto &[stoneA, stoneB] : resourcePool().allActionTwoExtraDraws()) {
+                const auto actionSeq = ActionSequence{std::array{Action::createDraw(stoneA), Action::createDraw(stoneB)}};
+                if (not utility::callVisitor(fn, actionSeq)) {
+                    return false;
+                }
             }
         }
+        return true;
     }
 
 private:
-    [[nodiscard]] auto actionPools() const noexcept -> const ActionPools& { return _state.actionPools(); }
+    /// The number of valid orientations for each unique stone of the active pool, on one position.
+    ///
+    using StoneWeights = std::array<uint8_t, ActionPool::capacity>;
+
+    /// The stone pairs that are dropped by two rotations.
+    ///
+    [[nodiscard]] auto droppedStonePairs() const noexcept -> UniqueStonePairs {
+        auto result = activePool().uniqueStonePairs();
+        if (_mode == ActionSequences::Mode::Canonical) {
+            erase_if(result, [](const StonePair &stonePair) { return stonePair.second < stonePair.first; });
+        }
+        return result;
+    }
+
+    /// The placed and dropped stones for two replacements.
+    ///
+    [[nodiscard]] auto replaceStoneQuads() const noexcept -> UniqueStoneQuads {
+        auto result = activePool().uniqueStoneQuads();
+        if (_mode == ActionSequences::Mode::Canonical) {
+            erase_if(result, [](const StoneQuad &stoneQuad) { return std::get<3>(stoneQuad) < std::get<2>(stoneQuad); });
+        }
+        return result;
+    }
+
+    template<typename IsValidFn>
+    [[nodiscard]] static auto countOrientations(IsValidFn &&isValid) noexcept -> uint8_t {
+        uint8_t result = 0;
+        for (const auto orientation : Orientation::all()) {
+            if (isValid(orientation)) {
+                result += 1;
+            }
+        }
+        return result;
+    }
+
+    template<typename IsValidFn>
+    [[nodiscard]] static auto orientationAt(std::size_t index, IsValidFn &&isValid) noexcept -> Orientation {
+        for (const auto orientation : Orientation::all()) {
+            if (isValid(orientation)) {
+                if (index == 0) {
+                    return orientation;
+                }
+                index -= 1;
+            }
+        }
+        return {};
+    }
+
+    [[nodiscard]] static auto placeFilter(const Stone stone) noexcept {
+        return [orientations = stone.uniqueOrientations()](const Orientation orientation) {
+            return orientations.contains(orientation);
+        };
+    }
+
+    [[nodiscard]] auto replaceFilter(const Position position, const Stone stone) const noexcept {
+        return [this, position, stone, orientations = stone.uniqueOrientations()](const Orientation orientation) {
+            return orientations.contains(orientation) and board().canPlayerReplaceStone(position, stone, orientation);
+        };
+    }
+
+    /// The valid rotations of the field at the given position. None, if the field can't be rotated.
+    ///
+    [[nodiscard]] auto rotateFilter(const Position position) const noexcept {
+        const auto &field = board().field(position);
+        const auto canRotate = not orbPositions().isOrbAt(position) and field.canRotate();
+        return [this, position, canRotate, current = field.orientation(), orientations = field.uniqueOrientations()](
+            const Orientation orientation) {
+            return canRotate and orientation != current and orientations.contains(orientation)
+                and board().canPlayerRotateStone(position, orientation);
+        };
+    }
+
+public: // census
+    /// The numbers needed to count and unrank the action sequences of a state.
+    ///
+    /// A census refers to its generator, and must not outlive it.
+    ///
+    struct Census {
+        explicit Census(const ActionGenerator &generator) noexcept : generator{generator} {
+            const auto stoneCount = generator.activePool().stoneCount();
+            stones = generator.activePool().uniqueStones();
+            stonePairs = generator.activePool().uniqueStonePairs();
+            droppedPairs = generator.droppedStonePairs();
+            placePositions = generator.board().allPlaceOneActionPositions(generator._perspective);
+            replacePositions = generator.board().allReplaceOneActionPositions();
+            rotatePositions = generator.board().allRotateOneActionPositions();
+            oneDraws = generator.resourcePool().allActionOneExtraDraw();
+            twoDraws = generator.resourcePool().allActionTwoExtraDraws();
+            if (stoneCount >= 4) {
+                stoneQuads = generator.replaceStoneQuads();
+            }
+            for (std::size_t i = 0; i < stones.size(); ++i) {
+                placeWeights[i] = countOrientations(placeFilter(stones[i]));
+            }
+            for (const auto position : replacePositions) {
+                StoneWeights weights{};
+                if (not generator.orbPositions().isOrbAt(position)) {
+                    for (std::size_t i = 0; i < stones.size(); ++i) {
+                        weights[i] = countOrientations(generator.replaceFilter(position, stones[i]));
+                    }
+                }
+                replaceWeights.push_back(weights);
+            }
+            for (std::size_t i = 0; i < rotatePositions.size(); ++i) {
+                rotateWeights[i] = countOrientations(generator.rotateFilter(rotatePositions[i]));
+            }
+            for (const auto &stoneQuad : stoneQuads) {
+                quadWeights[stoneIndex(std::get<0>(stoneQuad))][stoneIndex(std::get<1>(stoneQuad))] += 1;
+            }
+            countAll(stoneCount, generator.activePool().freeSlots());
+        }
+
+        /// The number of all action sequences.
+        ///
+        [[nodiscard]] auto total() const noexcept -> std::size_t {
+            return std::accumulate(counts.begin(), counts.end(), std::size_t{0});
+        }
+
+        void countAll(const uint8_t stoneCount, const uint8_t freeSlots) noexcept {
+            if (stoneCount >= 1) {
+                counts[index(Family::PlaceOne)] = placePositions.size() * placeWeightOne();
+                for (std::size_t i = 0; i < rotatePositions.size(); ++i) {
+                    counts[index(Family::RotateOne)] += rotateWeights[i] * stones.size();
+                }
+            }
+            if (stoneCount >= 2) {
+                counts[index(Family::PlaceTwo)] = pairCount(placePositions.size()) * placeWeightTwo();
+                for (std::size_t i = 0; i < replacePositions.size(); ++i) {
+                    counts[index(Family::ReplaceOne)] += replaceWeightOne(i);
+                }
+                for (std::size_t i = 0; i < rotatePositions.size(); ++i) {
+                    for (std::size_t j = i + 1; j < rotatePositions.size(); ++j) {
+                        counts[index(Family::RotateTwo)] += rotateWeights[i] * rotateWeights[j] * droppedPairs.size();
+                    }
+                }
+            }
+            if (stoneCount >= 4) {
+                for (std::size_t i = 0; i < replacePositions.size(); ++i) {
+                    for (std::size_t j = i + 1; j < replacePositions.size(); ++j) {
+                        counts[index(Family::ReplaceTwo)] += replaceWeightTwo(i, j);
+                    }
+                }
+            }
+            if (freeSlots > 1) { // need at least 2 free slots for extra draw
+                counts[index(Family::ExtraDrawOne)] = oneDraws.size();
+            }
+            if (freeSlots > 2) { // need at least 3 free slots for two extra draws
+                counts[index(Family::ExtraDrawTwo)] = twoDraws.size();
+            }
+        }
+
+        [[nodiscard]] auto actionAt(const Family family, std::size_t index) const noexcept -> ActionSequence {
+            switch (family) {
+            case Family::PlaceOne: {
+                const auto position = placePositions[index / placeWeightOne()];
+                index %= placeWeightOne();
+                for (std::size_t i = 0;; ++i) {
+                    if (index < placeWeights[i]) {
+                        return Action::createPlace(
+                            position, stones[i], orientationAt(index, placeFilter(stones[i])));
+                    }
+                    index -= placeWeights[i];
+                }
+            }
+            case Family::PlaceTwo: {
+                const auto [a, b] = pairAt(index / placeWeightTwo(), placePositions.size());
+                index %= placeWeightTwo();
+                for (const auto &stonePair : stonePairs) {
+                    const std::size_t weightA = placeWeights[stoneIndex(stonePair.first)];
+                    const std::size_t weightB = placeWeights[stoneIndex(stonePair.second)];
+                    if (index < weightA * weightB) {
+                        return std::array{
+                            Action::createPlace(placePositions[a], stonePair.first,
+                                orientationAt(index / weightB, placeFilter(stonePair.first))),
+                            Action::createPlace(placePositions[b], stonePair.second,
+                                orientationAt(index % weightB, placeFilter(stonePair.second)))
+                        };
+                    }
+                    index -= weightA * weightB;
+                }
+                break;
+            }
+            case Family::ReplaceOne: {
+                for (std::size_t i = 0; i < replacePositions.size(); ++i) {
+                    if (index >= replaceWeightOne(i)) {
+                        index -= replaceWeightOne(i);
+                        continue;
+                    }
+                    const auto position = replacePositions[i];
+                    for (const auto &stonePair : stonePairs) {
+                        const std::size_t weight = replaceWeights[i][stoneIndex(stonePair.first)];
+                        if (index < weight) {
+                            const auto orientation = orientationAt(
+                                index, generator.replaceFilter(position, stonePair.first));
+                            return Action::createReplace(position, stonePair.first, orientation, stonePair.second);
+                        }
+                        index -= weight;
+                    }
+                }
+                break;
+            }
+            case Family::ReplaceTwo: {
+                for (std::size_t i = 0; i < replacePositions.size(); ++i) {
+                    for (std::size_t j = i + 1; j < replacePositions.size(); ++j) {
+                        if (index >= replaceWeightTwo(i, j)) {
+                            index -= replaceWeightTwo(i, j);
+                            continue;
+                        }
+                        const auto positionA = replacePositions[i];
+                        const auto positionB = replacePositions[j];
+                        for (const auto &stoneQuad : stoneQuads) {
+                            const auto &[stoneA, stoneB, droppedA, droppedB] = stoneQuad;
+                            const std::size_t weightA = replaceWeights[i][stoneIndex(stoneA)];
+                            const std::size_t weightB = replaceWeights[j][stoneIndex(stoneB)];
+                            if (index < weightA * weightB) {
+                                const auto orientationA = orientationAt(
+                                    index / weightB, generator.replaceFilter(positionA, stoneA));
+                                const auto orientationB = orientationAt(
+                                    index % weightB, generator.replaceFilter(positionB, stoneB));
+                                return std::array{
+                                    Action::createReplace(positionA, stoneA, orientationA, droppedA),
+                                    Action::createReplace(positionB, stoneB, orientationB, droppedB)
+                                };
+                            }
+                            index -= weightA * weightB;
+                        }
+                    }
+                }
+                break;
+            }
+            case Family::RotateOne: {
+                for (std::size_t i = 0; i < rotatePositions.size(); ++i) {
+                    const auto weight = rotateWeights[i] * stones.size();
+                    if (index < weight) {
+                        const auto orientation = orientationAt(
+                            index / stones.size(), generator.rotateFilter(rotatePositions[i]));
+                        return Action::createRotate(rotatePositions[i], orientation, stones[index % stones.size()]);
+                    }
+                    index -= weight;
+                }
+                break;
+            }
+            case Family::RotateTwo: {
+                for (std::size_t i = 0; i < rotatePositions.size(); ++i) {
+                    for (std::size_t j = i + 1; j < rotatePositions.size(); ++j) {
+                        const auto weight = rotateWeights[i] * rotateWeights[j] * droppedPairs.size();
+                        if (index >= weight) {
+                            index -= weight;
+                            continue;
+                        }
+                        const auto &droppedPair = droppedPairs[index % droppedPairs.size()];
+                        index /= droppedPairs.size();
+                        const auto orientationA = orientationAt(
+                            index / rotateWeights[j], generator.rotateFilter(rotatePositions[i]));
+                        const auto orientationB = orientationAt(
+                            index % rotateWeights[j], generator.rotateFilter(rotatePositions[j]));
+                        return std::array{
+                            Action::createRotate(rotatePositions[i], orientationA, droppedPair.first),
+                            Action::createRotate(rotatePositions[j], orientationB, droppedPair.second)
+                        };
+                    }
+                }
+                break;
+            }
+            case Family::ExtraDrawOne:
+                return Action::createDraw(oneDraws[index]);
+            case Family::ExtraDrawTwo:
+                return std::array{Action::createDraw(twoDraws[index].first), Action::createDraw(twoDraws[index].second)};
+            default:
+                break;
+            }
+            return {};
+        }
+
+        [[nodiscard]] static constexpr auto index(const Family family) noexcept -> std::size_t {
+            return static_cast<std::size_t>(family);
+        }
+
+        /// The number of pairs `i < j` from `n` elements.
+        ///
+        [[nodiscard]] static constexpr auto pairCount(const std::size_t n) noexcept -> std::size_t {
+            return n < 2 ? 0 : n * (n - 1) / 2;
+        }
+
+        /// Get the pair `i < j` at the given index, in the order of two nested loops.
+        ///
+        [[nodiscard]] static constexpr auto pairAt(std::size_t index, const std::size_t n) noexcept
+                -> std::pair<std::size_t, std::size_t> {
+            std::size_t i = 0;
+            while (index >= n - 1 - i) {
+                index -= n - 1 - i;
+                i += 1;
+            }
+            return {i, i + 1 + index};
+        }
+
+        [[nodiscard]] auto stoneIndex(const Stone stone) const noexcept -> std::size_t {
+            return static_cast<std::size_t>(std::ranges::find(stones, stone) - stones.begin());
+        }
+
+        [[nodiscard]] auto placeWeightOne() const noexcept -> std::size_t {
+            return std::accumulate(placeWeights.begin(), placeWeights.end(), std::size_t{0});
+        }
+
+        [[nodiscard]] auto placeWeightTwo() const noexcept -> std::size_t {
+            std::size_t result = 0;
+            for (const auto &stonePair : stonePairs) {
+                result += static_cast<std::size_t>(placeWeights[stoneIndex(stonePair.first)])
+                    * placeWeights[stoneIndex(stonePair.second)];
+            }
+            return result;
+        }
+
+        [[nodiscard]] auto replaceWeightOne(const std::size_t i) const noexcept -> std::size_t {
+            std::size_t result = 0;
+            for (const auto &stonePair : stonePairs) {
+                result += replaceWeights[i][stoneIndex(stonePair.first)];
+            }
+            return result;
+        }
+
+        [[nodiscard]] auto replaceWeightTwo(const std::size_t i, const std::size_t j) const noexcept -> std::size_t {
+            std::size_t result = 0;
+            for (std::size_t a = 0; a < stones.size(); ++a) {
+                for (std::size_t b = 0; b < stones.size(); ++b) {
+                    result += static_cast<std::size_t>(replaceWeights[i][a]) * quadWeights[a][b] * replaceWeights[j][b];
+                }
+            }
+            return result;
+        }
+
+        const ActionGenerator &generator;
+        UniqueStones stones;
+        UniqueStonePairs stonePairs;
+        UniqueStonePairs droppedPairs; ///< The stones dropped by two rotations.
+        UniqueStoneQuads stoneQuads; ///< The stones placed and dropped by two replacements.
+        FieldPositions placePositions;
+        FieldPositions replacePositions;
+        FieldPositions rotatePositions;
+        ResourcePool::Draws oneDraws;
+        ResourcePool::DrawPairs twoDraws;
+        StoneWeights placeWeights{}; ///< The valid orientations to place each unique stone.
+        FixedList<StoneWeights, FieldPositions::capacity()> replaceWeights; ///< For each replace position.
+        std::array<uint8_t, FieldPositions::capacity()> rotateWeights{}; ///< For each rotate position.
+        std::array<std::array<uint16_t, ActionPool::capacity>, ActionPool::capacity> quadWeights{}; ///< Quads by the first two stones.
+        FamilyCounts counts{};
+    };
+
+private:
+    [[nodiscard]] auto activePool() const noexcept -> const ActionPool& { return _state.actionPools()[_perspective]; }
     [[nodiscard]] auto board() const noexcept -> const Board& { return _state.board(); }
     [[nodiscard]] auto orbPositions() const noexcept -> const OrbPositions& { return _state.orbPositions(); }
     [[nodiscard]] auto resourcePool() const noexcept -> const ResourcePool& { return _state.resourcePool(); }
 
 private:
-    GameState _state;
+    const GameState &_state;
+    Player _perspective; ///< The active player.
+    ActionSequences::Mode _mode; ///< Which action sequences are generated.
 };
 
+
+template<typename Fn>
+auto ActionSequences::forEachForState(
+    const GameState &state,
+    Fn &&fn,
+    const Player perspective,
+    const Mode mode) noexcept -> bool {
+
+    return ActionGenerator{state, perspective, mode}.forEachAction(std::forward<Fn>(fn));
+}
+
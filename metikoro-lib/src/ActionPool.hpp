@@ -12,3 +12,4 @@ using ActionPool = StonePool<setup::actionPoolSize>;
 
 
 static_assert(Serializable<ActionPool>);
+static_assert(BinarySerializable<ActionPool>);
@@ -7,8 +7,6 @@
 
 
 class ActionPools {
-    friend struct std::hash<ActionPools>;
-
 public:
     ActionPools() = default;
 
@@ -35,8 +33,30 @@ public:
         return _actionPools.front();
     }
 
+    /// The Zobrist key for all action pools.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key {
+        zobrist::Key result{};
+        for (const auto player : Player::all()) {
+            result ^= zobrist::playerPoolKey(_actionPools[player].zobristKey(), player);
+        }
+        return result;
+    }
+
+    /// The Zobrist key for the action pools of a rotated state, without rotating the pools.
+    ///
+    [[nodiscard]] auto zobristKey(const Rotation rotation) const noexcept -> zobrist::Key {
+        const auto offset = static_cast<std::size_t>(rotation.wrapToClockwise().value());
+        zobrist::Key result{};
+        for (const auto player : Player::all()) {
+            const auto &pool = _actionPools.at((player.value() + offset) % _actionPools.size());
+            result ^= zobrist::playerPoolKey(pool.zobristKey(), player);
+        }
+        return result;
+    }
+
     [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> ActionPools {
-        return ActionPools(rotatedLeft(_actionPools, rotation.value()));
+        return ActionPools(rotatedLeft(_actionPools, static_cast<std::size_t>(rotation.wrapToClockwise().value())));
     }
 
 public: // serialization
@@ -61,6 +81,21 @@ public: // serialization
         return ActionPools{actionPools};
     }
 
+public: // binary serialization
+    void addToBinary(std::string &data) const noexcept {
+        for (const auto &pool : _actionPools) {
+            pool.addToBinary(data);
+        }
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> ActionPools {
+        std::array<ActionPool, Player::count> actionPools;
+        for (auto &pool : actionPools) {
+            pool = ActionPool::fromBinary(reader);
+        }
+        return ActionPools{actionPools};
+    }
+
 private:
     template<typename T, std::size_t N>
     static auto rotatedLeft(const std::array<T, N> &arr, std::size_t rotations) -> std::array<T, N> {
@@ -82,12 +117,13 @@ private:
 
 
 static_assert(Serializable<ActionPools>);
+static_assert(BinarySerializable<ActionPools>);
 
 
 template<>
 struct std::hash<ActionPools> {
     auto operator()(const ActionPools &actionPools) const noexcept -> std::size_t {
-        return utility::hashFromArray(actionPools._actionPools);
+        return actionPools.zobristKey();
     }
 };
 
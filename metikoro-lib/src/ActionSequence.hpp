@@ -41,14 +41,27 @@ public:
 
     /// Execute all actions from this action sequence for the given state.
     ///
-    void applyTo(GameState &state) const {
+    /// @param state The state to modify.
+    /// @param perspective The player executing the actions. Player 0, if the state is rotated for the active player.
+    ///
+    void applyTo(GameState &state, const Player perspective = Player{0}) const {
         for (const Action &action : sequence()) {
             if (not action.isNone()) {
-                action.applyTo(state);
+                action.applyTo(state, perspective);
             }
         }
     }
 
+    /// Create a rotated version of this sequence, matching a rotated state.
+    ///
+    [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> ActionSequence {
+        ActionSequence result;
+        for (std::size_t i = 0; i < _sequence.size(); ++i) {
+            result._sequence.at(i) = _sequence.at(i).rotated(rotation);
+        }
+        return result;
+    }
+
     /// Create a string for this sequence for debugging.
     ///
     [[nodiscard]] auto toString() const noexcept -> std::string {
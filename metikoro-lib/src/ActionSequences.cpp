@@ -6,8 +6,12 @@
 #include "ActionGenerator.hpp"
 
 
-auto ActionSequences::allForState(const GameState &state) noexcept -> ActionSequences {
-    return ActionGenerator{state}.all();
+auto ActionSequences::allForState(
+    const GameState &state,
+    const Player perspective,
+    const Mode mode) noexcept -> ActionSequences {
+
+    return ActionGenerator{state, perspective, mode}.all();
 }
 
 
@@ -4,6 +4,10 @@
 
 
 #include "ActionSequence.hpp"
+#include "Player.hpp"
+
+#include <cstdint>
+#include <vector>
 
 
 class GameState;
@@ -13,6 +17,13 @@ class ActionSequences {
 public:
     using Actions = std::vector<ActionSequence>;
 
+    /// Which action sequences are generated.
+    ///
+    enum class Mode : uint8_t {
+        All, ///< Every valid action sequence.
+        Canonical, ///< Only one action sequence for each distinct resulting state.
+    };
+
 public:
     ActionSequences() = default;
 
@@ -32,7 +43,33 @@ public:
 
     /// Generate all valid action sequences for the given state.
     ///
-    [[nodiscard]] static auto allForState(const GameState &state) noexcept -> ActionSequences;
+    /// @param state The state.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are generated.
+    ///
+    [[nodiscard]] static auto allForState(
+        const GameState &state,
+        Player perspective = Player{0},
+        Mode mode = Mode::All) noexcept -> ActionSequences;
+
+    /// Call a function for each valid action sequence for the given state, without creating a list.
+    ///
+    /// The visitor is a template parameter, so it is called directly and no memory is allocated. This
+    /// method is defined in `ActionGenerator.hpp`, that is included by `GameState.hpp`.
+    ///
+    /// @param state The state.
+    /// @param fn The visitor, called with a `const ActionSequence&`. If it returns `bool`, `false` stops
+    ///     the iteration.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are generated.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    static auto forEachForState(
+        const GameState &state,
+        Fn &&fn,
+        Player perspective = Player{0},
+        Mode mode = Mode::All) noexcept -> bool;
 
 private:
     std::vector<ActionSequence> _actions;
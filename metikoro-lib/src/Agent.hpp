@@ -50,12 +50,20 @@ public:
     ///
     /// This method is called once in the main thread, *before* the threads are starting.
     /// If your agent is stateless, you can return its own instance.
+    /// Each copy plays one game at a time, but consecutive games may run on different worker threads.
+    /// To evaluate moves in parallel, use a `TaskGroup` on `TaskScheduler::current()`.
     ///
     virtual auto copyForThread() noexcept -> AgentPtr = 0;
 
     /// Called before a new game starts.
     ///
-    virtual void gameStart() = 0;
+    /// In a reproducible run, every game and every player gets its own seed, derived from the seed of the
+    /// run and the index of the game. Agents that use random numbers should seed them from it, so the game
+    /// does not depend on the thread that simulates it.
+    ///
+    /// @param gameSeed The seed for this agent in this game, or zero if the run is not reproducible.
+    ///
+    virtual void gameStart(uint64_t gameSeed) = 0;
 
     /// Choose the next move for this state and game log.
     ///
@@ -68,6 +76,29 @@ public:
         const GameState &state,
         const GameLog &gameLog) -> GameMove = 0;
 
+    /// Choose the next move for a state in its original position.
+    ///
+    /// The simulation keeps the state in its original position and passes the active player instead of
+    /// rotating the state every turn. The default implementation rotates the state into the view of the
+    /// player, calls `nextMove()` and rotates the move back. Agents that can work with a perspective
+    /// should override this method, to avoid both rotations.
+    ///
+    /// @warning This method *must be thread safe*! It is called from all simulation threads.
+    ///
+    /// @param state The current state in its original position.
+    /// @param player The player this agent is playing.
+    /// @param gameLog The game log so far.
+    /// @return The move, in the original position.
+    ///
+    [[nodiscard]] virtual auto nextMoveForPlayer(
+        const GameState &state,
+        const Player player,
+        const GameLog &gameLog) -> GameMove {
+
+        const auto rotation = GameState::rotationToPlayer(player);
+        return nextMove(state.rotatedToPlayer(player), gameLog).rotated(rotation.reversed());
+    }
+
     /// Called after a game ended.
     ///
     /// @param gameLog The game log.
@@ -5,7 +5,9 @@
 
 #include <random>
 
+#include "ActionGenerator.hpp"
 #include "Agent.hpp"
+#include "Utilities.hpp"
 
 
 class AgentRandom;
@@ -35,11 +37,15 @@ private:
         if (elements.size() == 0) {
             throw Error("AgentRandom: Empty elements container to choose from.");
         }
-        if (elements.size() == 1) {
-            return elements.at(0);
+        return elements.at(randomIndex(elements.size()));
+    }
+
+    auto randomIndex(const std::size_t size) -> std::size_t {
+        if (size == 1) {
+            return 0;
         }
-        std::uniform_int_distribution<std::size_t> actionsDist(0, elements.size() - 1);
-        return elements.at(actionsDist(_rng));
+        std::uniform_int_distribution<std::size_t> actionsDist(0, size - 1);
+        return actionsDist(_rng);
     }
 
     void initializeRngFromSeed() noexcept {
@@ -50,6 +56,11 @@ private:
         }
     }
 
+    void initializeRngFromGameSeed(const uint64_t gameSeed) noexcept {
+        utility::SeedSequence sequence{static_cast<uint32_t>(gameSeed), static_cast<uint32_t>(gameSeed >> 32U)};
+        _rng.seed(sequence);
+    }
+
 public:
     [[nodiscard]] static auto getHelp() noexcept -> std::string {
         return "  --seed=<rng seed>    A positive 64-bit number as seed for the prng. 0 = random seed.";
@@ -77,30 +88,51 @@ public:
         return result.str();
     }
 
+    /// Create a copy with its own random stream.
+    ///
+    /// With a configured seed, each copy gets a seed derived from it, so the copies play different games.
+    ///
     auto copyForThread() noexcept -> AgentPtr override {
         auto copy = std::make_shared<AgentRandom>(*this);
+        if (_seed != 0) {
+            copy->_seed = utility::deriveSeed(_seed, _copyCount++);
+        }
         copy->initializeRngFromSeed();
         return copy;
     }
 
-    void gameStart() override {
-        // not used.
+    void gameStart(const uint64_t gameSeed) override {
+        if (gameSeed != 0) {
+            initializeRngFromGameSeed(gameSeed);
+        }
     }
 
-    [[nodiscard]] auto nextMove(const GameState &state, const GameLog& /*gameLog*/) -> GameMove override {
-        const auto allActions = state.allActions();
+    [[nodiscard]] auto nextMove(const GameState &state, const GameLog &gameLog) -> GameMove override {
+        return nextMoveForPlayer(state, Player{0}, gameLog);
+    }
+
+    [[nodiscard]] auto nextMoveForPlayer(
+        const GameState &state,
+        const Player player,
+        const GameLog& /*gameLog*/) -> GameMove override {
+
+        // Only the selected action is created, instead of generating all of them. The census is built once,
+        // to count the actions and to create the selected one.
+        const ActionGenerator actionGenerator{state, player};
+        const auto census = actionGenerator.census();
+        const auto actionCount = census.total();
         auto tempState = state;
         ActionSequence actionSequence;
-        if (allActions.empty()) {
+        if (actionCount == 0) {
             if constexpr (not allowNoActions) {
                 throw Error("AgentRandom: There was no possible action to select from.");
             }
             actionSequence = {};
         } else {
-            actionSequence = selectRandom(allActions.actions());
-            actionSequence.applyTo(tempState);
+            actionSequence = ActionGenerator::actionAt(census, randomIndex(actionCount));
+            actionSequence.applyTo(tempState, player);
         }
-        const auto allRegularDraws = tempState.allRegularDraws();
+        const auto allRegularDraws = tempState.allRegularDraws(player);
         Stone drawStone;
         if (allRegularDraws.empty()) {
             if constexpr (not allowNoDraw) {
@@ -108,9 +140,9 @@ public:
             }
             drawStone = {};
         } else {
-            drawStone = selectRandom(tempState.allRegularDraws());
+            drawStone = selectRandom(allRegularDraws);
         }
-        const auto orbMove = selectRandom(tempState.allOrbMoves());
+        const auto orbMove = selectRandom(tempState.allOrbMoves(player));
         return GameMove{actionSequence, drawStone, orbMove};
     }
 
@@ -127,6 +159,7 @@ private:
     std::size_t _seed{0};
 
     // working
+    uint64_t _copyCount{0}; ///< The number of copies created, to derive their seeds.
     std::mt19937 _rng{};
 };
 
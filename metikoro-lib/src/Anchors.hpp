@@ -22,12 +22,12 @@ public: // operators
     [[nodiscard]] constexpr auto operator==(const Anchors &other) const noexcept -> bool { return _points == other._points; }
     [[nodiscard]] constexpr auto operator!=(const Anchors &other) const noexcept -> bool { return _points != other._points; }
 
-    auto operator|=(const Anchor::Value value) noexcept -> Anchors& { _points |= Anchor{value}.flag(); return *this; }
-    auto operator|=(const Anchor &other) noexcept -> Anchors& { _points |= other.flag(); return *this; }
-    auto operator|=(const Anchors &other) noexcept -> Anchors& { _points |= other._points; return *this; }
-    [[nodiscard]] auto operator|(const Anchor::Value value) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | Anchor{value}.flag())}; }
-    [[nodiscard]] auto operator|(const Anchor &other) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | other.flag())}; }
-    [[nodiscard]] auto operator|(const Anchors &other) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | other._points)}; }
+    constexpr auto operator|=(const Anchor::Value value) noexcept -> Anchors& { _points |= Anchor{value}.flag(); return *this; }
+    constexpr auto operator|=(const Anchor &other) noexcept -> Anchors& { _points |= other.flag(); return *this; }
+    constexpr auto operator|=(const Anchors &other) noexcept -> Anchors& { _points |= other._points; return *this; }
+    [[nodiscard]] constexpr auto operator|(const Anchor::Value value) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | Anchor{value}.flag())}; }
+    [[nodiscard]] constexpr auto operator|(const Anchor &other) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | other.flag())}; }
+    [[nodiscard]] constexpr auto operator|(const Anchors &other) const noexcept -> Anchors { return Anchors{static_cast<uint8_t>(_points | other._points)}; }
     [[nodiscard]] friend auto operator|(const Anchor::Value lhs, const Anchor::Value rhs) noexcept -> Anchors { return Anchors{lhs} | Anchor{rhs}; }
     [[nodiscard]] friend auto operator|(const Anchor &lhs, const Anchors &rhs) noexcept -> Anchors { return Anchors{lhs} | rhs; }
     [[nodiscard]] friend auto operator|(const Anchor &lhs, const Anchor &rhs) noexcept -> Anchors { return Anchors{lhs} | rhs; }
@@ -90,7 +90,7 @@ public: // conversion
     }
 
 public: // modifiers
-    void remove(const Anchor connectionPoint) noexcept {
+    constexpr void remove(const Anchor connectionPoint) noexcept {
         _points &= ~connectionPoint.flag();
     }
 
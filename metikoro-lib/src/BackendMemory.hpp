@@ -7,51 +7,434 @@
 #include "GameLog.hpp"
 #include "GameState.hpp"
 #include "RatingGame.hpp"
+#include "StateFingerprint.hpp"
+#include "StateRatingSnapshot.hpp"
+#include "StateRatingTable.hpp"
+#include "StateRatingView.hpp"
+#include "Zobrist.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 
 
 
+/// A backend that keeps all states in memory.
+///
+/// The states are striped over shards by their hash, and each shard has its own lock. A game is prepared
+/// without holding any lock, and its adjustments are applied grouped by shard, so each shard is only locked
+/// once per game, and threads only wait for each other if they update the same shard at the same time.
+///
+/// Each shard stores the ratings in a compact table, keyed by the 128-bit fingerprints of the states. The
+/// combined ratings are stored as doubles, unless `--compact-ratings` trades their precision for memory.
+/// @see StateRatingTable
+///
+/// With a snapshot file, the ratings are kept between runs. On load, the snapshot is mapped into memory and
+/// used in place as the read-only base of each shard, and new adjustments are collected in the table of the
+/// shard. A background thread periodically merges the base and the collected changes into a new snapshot,
+/// and a final snapshot is written on shutdown. While a snapshot is written, the collected changes of a shard
+/// are moved aside as pending, and the simulation threads continue with an empty table, so they are only
+/// blocked for the moment the tables of a shard are swapped.
+/// @see StateRatingSnapshot
+///
 class BackendMemory final : public Backend {
+public:
+    /// The default number of shards.
+    constexpr static std::size_t defaultShardCount = 64;
+    /// The maximum number of shards.
+    constexpr static std::size_t maximumShardCount = 4096;
+    /// The default interval for background snapshots.
+    constexpr static std::chrono::seconds defaultSnapshotInterval{300};
+
 public:
     BackendMemory() = default;
 
 public:
     [[nodiscard]] static auto getHelp() noexcept -> std::string {
-        return "  no options";
+        std::string result;
+        result += "  --canonical-states   Store all rotations of a state as one canonical state. This merges\n";
+        result += "                       states that only differ in the player to move.\n";
+        result += "  --shards=<count>     The number of independently locked shards, a power of two.\n";
+        result += std::format("                       Default is {}.\n", defaultShardCount);
+        result += "  --compact-ratings    Store the combined ratings as 32-bit floats instead of doubles, to\n";
+        result += "                       save 16 of 72 bytes per state. The sums of frequent states lose\n";
+        result += "                       small adjustments to rounding, once they exceed about 1e5.\n";
+        result += "  --expected-states=<count>\n";
+        result += "                       Reserve memory for this number of states up front.\n";
+        result += "  --snapshot=<path>    Load the states from this snapshot file, if it exists, and write\n";
+        result += "                       the states into it in the background and on shutdown.\n";
+        result += "  --snapshot-interval=<seconds>\n";
+        result += std::format("                       The interval for background snapshots, zero to only write\n"
+                              "                       the snapshot on shutdown. Default is {}.\n",
+                              defaultSnapshotInterval.count());
+        return result;
     }
 
     void initialize(std::span<std::string_view> args) override {
         for (const auto &arg : args) {
-            throw Error{"Unknown memory backend option: " + std::string{arg}};
+            if (arg == "--canonical-states") {
+                _canonicalStates = true;
+            } else if (arg.starts_with("--shards=")) {
+                const auto count = std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)});
+                if (count < 1 or count > maximumShardCount or not std::has_single_bit(count)) {
+                    throw Error{std::format("Invalid shard count: {}", count)};
+                }
+                _shardCount = static_cast<std::size_t>(count);
+                _shardCountSet = true;
+            } else if (arg == "--compact-ratings") {
+                _precision = RatingPrecision::Float;
+            } else if (arg.starts_with("--expected-states=")) {
+                _expectedStates = std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)});
+            } else if (arg.starts_with("--snapshot=")) {
+                _snapshotPath = arg.substr(arg.find_first_of('=') + 1);
+                if (_snapshotPath.empty()) {
+                    throw Error{"The snapshot path must not be empty."};
+                }
+            } else if (arg.starts_with("--snapshot-interval=")) {
+                _snapshotInterval = std::chrono::seconds{
+                    std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)})};
+            } else {
+                throw Error{"Unknown memory backend option: " + std::string{arg}};
+            }
+        }
+        createShards();
+    }
+
+    void displayConfiguration() noexcept override {
+        writeLog(std::format("  shards.....................: {}", _shardCount), Color::Default);
+        if (_precision == RatingPrecision::Float) {
+            writeLog("  compact-ratings............: yes", Color::Default);
+        }
+        if (_expectedStates > 0) {
+            writeLog(std::format("  expected-states............: {}", _expectedStates), Color::Default);
+        }
+        if (not _snapshotPath.empty()) {
+            writeLog(std::format("  snapshot...................: {}", _snapshotPath.string()), Color::Default);
+            writeLog(std::format("  snapshot-interval..........: {}s", _snapshotInterval.count()), Color::Default);
         }
     }
 
     void load() override {
-        // unused
+        if (_snapshotPath.empty()) {
+            return;
+        }
+        if (std::filesystem::exists(_snapshotPath)) {
+            auto snapshot = StateRatingSnapshot::open(_snapshotPath);
+            if (snapshot->canonicalStates() != _canonicalStates) {
+                throw Error{std::format("The snapshot {} uses another state form.", _snapshotPath.string())};
+            }
+            if (snapshot->shardCount() != _shardCount) {
+                if (_shardCountSet or snapshot->shardCount() > maximumShardCount) {
+                    throw Error{std::format("The snapshot {} uses {} shards.",
+                        _snapshotPath.string(), snapshot->shardCount())};
+                }
+                _shardCount = snapshot->shardCount();
+                createShards();
+            }
+            // A snapshot with another precision is read as it is, the next snapshot uses the configured one.
+            for (std::size_t i = 0; i < _shardCount; ++i) {
+                _shards[i].base = snapshot->shard(i);
+                _shards[i].updateStateCount();
+            }
+            _snapshot = std::move(snapshot);
+            writeLog(std::format("Memory: Mapped {} states from the snapshot.", _snapshot->recordCount()), Color::Green);
+        }
+        if (_snapshotInterval.count() > 0) {
+            _snapshotThread = std::jthread{[this](const std::stop_token &stopToken) {
+                snapshotThread(stopToken);
+            }};
+        }
     }
 
     void addGame(const GameLog &gameLog) override {
         if (gameLog.empty()) {
             return;
         }
-        std::unique_lock const lock(_libraryMutex);
         auto adjustments = gameLog.createRatingAdjustments();
         if (gameLog.size() != adjustments.size()) {
             throw Error("Adjustments do not match game log size.");
         }
+        // Prepare all updates without a lock, then apply them shard by shard.
+        std::vector<Update> updates;
+        updates.reserve(gameLog.size());
+        std::string buffer;
         for (const auto &[turn, adjustment] : std::views::zip(gameLog, adjustments)) {
-            _gameStates[turn.state].applyAdjustment(adjustment);
+            if (_canonicalStates) {
+                auto canonicalAdjustment = adjustment;
+                canonicalAdjustment.rotate(turn.canonicalRotation());
+                updates.emplace_back(StateFingerprint::fromState(turn.canonicalState(), buffer), canonicalAdjustment);
+            } else {
+                updates.emplace_back(StateFingerprint::fromState(turn.playerState(), buffer), adjustment);
+            }
+            updates.back().shard = shardIndex(updates.back().fingerprint);
+        }
+        // The sort is stable, so repeated states in one game are adjusted in the order of the turns.
+        std::ranges::stable_sort(updates, {}, &Update::shard);
+        for (auto first = updates.begin(); first != updates.end(); ) {
+            const auto last = std::ranges::find_if(
+                first, updates.end(), [shard = first->shard](const Update &update) { return update.shard != shard; });
+            auto &shard = _shards[first->shard];
+            std::unique_lock const lock{shard.mutex};
+            for (auto it = first; it != last; ++it) {
+                const auto recordCount = shard.changes.size();
+                shard.changes.applyAdjustment(it->fingerprint, it->adjustment);
+                if (shard.changes.size() != recordCount and not shard.isStored(it->fingerprint)) {
+                    shard.stateCount += 1;
+                }
+            }
+            first = last;
+        }
+    }
+
+    /// The number of stored states.
+    ///
+    [[nodiscard]] auto stateCount() const noexcept -> std::size_t {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < _shardCount; ++i) {
+            std::unique_lock const lock{_shards[i].mutex};
+            result += _shards[i].stateCount;
         }
+        return result;
+    }
+
+    /// Get the accumulated rating of a state.
+    ///
+    /// @param state The state, in the stored form: canonical, or from the view of the active player.
+    /// @return The rating, or no value if the state has no rating.
+    ///
+    [[nodiscard]] auto rating(const GameState &state) const noexcept -> std::optional<RatingGame> {
+        const auto fingerprint = StateFingerprint::fromState(state);
+        const auto &shard = _shards[shardIndex(fingerprint)];
+        std::unique_lock const lock{shard.mutex};
+        const auto record = shard.record(fingerprint);
+        if (not record.has_value()) {
+            return std::nullopt;
+        }
+        return record->toRating();
+    }
+
+    /// Report the number of states, the load factor and the memory use of the states.
+    ///
+    /// The memory use does not include the mapped snapshot.
+    ///
+    [[nodiscard]] auto status() const noexcept -> std::string override {
+        std::size_t stateCount = 0;
+        std::size_t recordCount = 0;
+        std::size_t slotCount = 0;
+        std::size_t memoryUse = 0;
+        for (std::size_t i = 0; i < _shardCount; ++i) {
+            const auto &shard = _shards[i];
+            std::unique_lock const lock{shard.mutex};
+            recordCount += shard.base.size() + shard.pending.size() + shard.changes.size();
+            slotCount += shard.base.slotCount() + shard.pending.slotCount() + shard.changes.slotCount();
+            stateCount += shard.stateCount;
+            memoryUse += shard.pending.memoryUse() + shard.changes.memoryUse();
+        }
+        const auto loadFactor = slotCount > 0
+            ? static_cast<double>(recordCount) / static_cast<double>(slotCount) : 0.0;
+        return std::format("OK: {} states, load factor {:.2f}, {:.1f} MiB.",
+            stateCount, loadFactor, static_cast<double>(memoryUse) / (1024.0 * 1024.0));
     }
 
     void shutdown() override {
-        // unused
+        if (_snapshotPath.empty()) {
+            return;
+        }
+        if (_snapshotThread.joinable()) {
+            _snapshotThread.request_stop();
+            _snapshotThread.join();
+        }
+        writeLog("Memory: Writing the final snapshot.", Color::Orange);
+        writeSnapshot();
+        writeStatus("Memory: Snapshot written.", Color::Green);
+    }
+
+    /// Write the states into the snapshot file.
+    ///
+    /// The snapshot is written while the simulation threads continue. Each shard is only locked briefly to
+    /// move its changes aside, and again to switch to the new snapshot as base.
+    ///
+    /// @throws Error If the snapshot can not be written. The changes are kept for the next snapshot.
+    ///
+    void writeSnapshot() {
+        if (_snapshotPath.empty()) {
+            return;
+        }
+        std::unique_lock const snapshotLock{_snapshotMutex};
+        std::size_t pendingCount = 0;
+        for (std::size_t i = 0; i < _shardCount; ++i) {
+            auto &shard = _shards[i];
+            std::unique_lock const lock{shard.mutex};
+            if (shard.pending.empty()) {
+                std::swap(shard.pending, shard.changes);
+            } else {
+                // The last snapshot failed, keep collecting into the pending changes.
+                const auto changes = shard.changes.view();
+                for (StateRatingView::Index index = 0; index < changes.size(); ++index) {
+                    shard.pending.addRecord(changes.fingerprint(index), changes.record(index));
+                }
+                shard.changes.clear();
+            }
+            pendingCount += shard.pending.size();
+        }
+        if (pendingCount == 0 and _snapshot != nullptr) {
+            return; // nothing changed.
+        }
+        // Only this method modifies the base and the pending changes, so they can be read without the lock.
+        StateRatingSnapshot::write(_snapshotPath, _shardCount, _canonicalStates, [this](const std::size_t shardIndex) {
+            const auto &shard = _shards[shardIndex];
+            StateRatingTable table{_precision};
+            table.reserve(shard.base.size() + shard.pending.size());
+            for (const auto &view : {shard.base, shard.pending.view()}) {
+                for (StateRatingView::Index index = 0; index < view.size(); ++index) {
+                    table.addRecord(view.fingerprint(index), view.record(index));
+                }
+            }
+            return table;
+        });
+        auto snapshot = StateRatingSnapshot::open(_snapshotPath);
+        for (std::size_t i = 0; i < _shardCount; ++i) {
+            auto &shard = _shards[i];
+            std::unique_lock const lock{shard.mutex};
+            shard.base = snapshot->shard(i);
+            shard.pending.clear();
+            shard.updateStateCount();
+        }
+        // All shards switched to the new snapshot, so the previous mapping can be released.
+        _snapshot = std::move(snapshot);
+    }
+
+private:
+    /// One shard of the states, with its own lock.
+    ///
+    struct alignas(64) Shard {
+        /// Test if a state is stored in the base or in the pending changes.
+        ///
+        [[nodiscard]] auto isStored(const StateFingerprint &fingerprint) const noexcept -> bool {
+            return base.find(fingerprint) != StateRatingView::emptySlot
+                or pending.view().find(fingerprint) != StateRatingView::emptySlot;
+        }
+
+        /// Get the merged counters of a state.
+        ///
+        [[nodiscard]] auto record(const StateFingerprint &fingerprint) const noexcept -> std::optional<StateRatingRecord> {
+            std::optional<StateRatingRecord> result;
+            for (const auto &view : {base, pending.view(), changes.view()}) {
+                if (const auto record = view.record(fingerprint); record.has_value()) {
+                    if (result.has_value()) {
+                        *result += *record;
+                    } else {
+                        result = record;
+                    }
+                }
+            }
+            return result;
+        }
+
+        /// Recalculate the number of states, after the base or the pending changes were replaced.
+        ///
+        void updateStateCount() noexcept {
+            stateCount = base.size();
+            const auto pendingView = pending.view();
+            for (StateRatingView::Index index = 0; index < pendingView.size(); ++index) {
+                if (base.find(pendingView.fingerprint(index)) == StateRatingView::emptySlot) {
+                    stateCount += 1;
+                }
+            }
+            const auto changesView = changes.view();
+            for (StateRatingView::Index index = 0; index < changesView.size(); ++index) {
+                if (not isStored(changesView.fingerprint(index))) {
+                    stateCount += 1;
+                }
+            }
+        }
+
+        mutable std::mutex mutex;
+        StateRatingView base; ///< The states from the snapshot.
+        StateRatingTable pending; ///< The changes that are currently written into a snapshot.
+        StateRatingTable changes; ///< The changes since the last snapshot.
+        std::size_t stateCount{0}; ///< The number of distinct states in this shard.
+    };
+
+    /// A prepared update for one state.
+    ///
+    struct Update {
+        Update(const StateFingerprint &fingerprint, const RatingAdjustment &adjustment) noexcept
+            : fingerprint{fingerprint}, adjustment{adjustment} {
+        }
+
+        StateFingerprint fingerprint; ///< The fingerprint of the state to update.
+        RatingAdjustment adjustment; ///< The adjustment for the state.
+        std::size_t shard{0}; ///< The index of the shard of the state.
+    };
+
+    /// Get the shard for a state.
+    ///
+    /// The Zobrist key is mixed again, and the table of the shard uses the other half of the fingerprint, so
+    /// the shards do not correlate with the slots of the tables.
+    ///
+    [[nodiscard]] auto shardIndex(const StateFingerprint &fingerprint) const noexcept -> std::size_t {
+        return static_cast<std::size_t>(zobrist::mix(fingerprint.high)) & (_shardCount - 1);
+    }
+
+    /// Create empty shards for the current configuration.
+    ///
+    void createShards() {
+        _shards = std::make_unique<Shard[]>(_shardCount);
+        for (std::size_t i = 0; i < _shardCount; ++i) {
+            _shards[i].pending = StateRatingTable{_precision};
+            _shards[i].changes = StateRatingTable{_precision};
+        }
+        if (_expectedStates > 0) {
+            // The states are evenly distributed, add a small margin for the deviation of the shards.
+            const auto statesPerShard = _expectedStates / _shardCount;
+            for (std::size_t i = 0; i < _shardCount; ++i) {
+                _shards[i].changes.reserve(statesPerShard + (statesPerShard / 32) + 64);
+            }
+        }
+    }
+
+    /// The thread that periodically writes the snapshot.
+    ///
+    void snapshotThread(const std::stop_token &stopToken) {
+        while (not stopToken.stop_requested()) {
+            {
+                std::unique_lock lock{_snapshotWaitMutex};
+                _snapshotWait.wait_for(lock, stopToken, _snapshotInterval, [] { return false; });
+            }
+            if (stopToken.stop_requested()) {
+                break; // the final snapshot is written by `shutdown()`.
+            }
+            try {
+                writeSnapshot();
+            } catch (const Error &error) {
+                writeLog(std::format("Memory: Could not write the snapshot: {}", error.what()), Color::Red);
+            }
+        }
     }
 
 private:
-    std::mutex _libraryMutex; ///< The mutex to allow multithreaded access.
-    std::unordered_map<GameState, RatingGame> _gameStates; ///< All known game states.
+    bool _canonicalStates{false}; ///< If all rotations of a state are stored as one canonical state.
+    std::size_t _shardCount{defaultShardCount}; ///< The number of shards, a power of two.
+    bool _shardCountSet{false}; ///< If the number of shards was set explicitly.
+    std::size_t _expectedStates{0}; ///< The number of states to reserve memory for, or zero.
+    RatingPrecision _precision{RatingPrecision::Double}; ///< The precision of the stored combined ratings.
+    std::filesystem::path _snapshotPath; ///< The path of the snapshot file, or empty for no snapshot.
+    std::chrono::seconds _snapshotInterval{defaultSnapshotInterval}; ///< The interval for background snapshots.
+    std::unique_ptr<Shard[]> _shards{std::make_unique<Shard[]>(defaultShardCount)}; ///< The shards.
+    std::shared_ptr<const StateRatingSnapshot> _snapshot; ///< The mapped snapshot, used as base of the shards.
+    std::mutex _snapshotMutex; ///< Serializes writing snapshots.
+    std::mutex _snapshotWaitMutex; ///< The mutex for the interval of the snapshot thread.
+    std::condition_variable_any _snapshotWait; ///< Wakes the snapshot thread on stop.
+    std::jthread _snapshotThread; ///< The thread for background snapshots, declared last to stop it first.
 };
 
@@ -0,0 +1,41 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Error.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+
+/// Reads binary data, that was created using the `addToBinary()` methods.
+///
+/// The reader keeps the current read position, so nested objects can read their part of the data
+/// without knowing its size in advance.
+///
+class BinaryReader {
+public:
+    explicit BinaryReader(const std::string_view data) noexcept : _data{data} {}
+
+public:
+    /// Test if all data was read.
+    ///
+    [[nodiscard]] auto atEnd() const noexcept -> bool { return _position >= _data.size(); }
+
+    /// Read the next byte.
+    ///
+    /// @throws Error if there is no data left.
+    ///
+    [[nodiscard]] auto readByte() -> uint8_t {
+        if (atEnd()) {
+            throw Error("BinaryReader: Unexpected end of data.");
+        }
+        return static_cast<uint8_t>(_data[_position++]);
+    }
+
+private:
+    std::string_view _data; ///< The data to read.
+    std::size_t _position{0}; ///< The current read position.
+};
+
@@ -7,9 +7,12 @@
 #include "Error.hpp"
 #include "Field.hpp"
 #include "FieldGrid.hpp"
+#include "FixedList.hpp"
 #include "GridOutput.hpp"
 #include "Position.hpp"
+#include "PositionMask.hpp"
 #include "Setup.hpp"
+#include "Zobrist.hpp"
 
 #include <array>
 #include <numeric>
@@ -32,10 +35,25 @@
 
 
 class Board {
-    friend struct std::hash<Board>;
-
 public:
     using State = FieldGrid<Field, setup::boardSize - 2>;
+    using Plane = PositionMask<setup::boardSize - 2, 1>; ///< One bit for each field in the state.
+    using Mask = BoardFrame::Mask; ///< One bit for each field on the board.
+    using FieldPositions = FixedList<Position, Plane::bitCount>; ///< A list of positions in the state.
+
+    /// Bit planes for the fields in the state.
+    ///
+    /// The planes are derived from the state and updated with every change of a field. They allow answering
+    /// most queries about the board with a few bit operations, instead of testing every field.
+    ///
+    struct Planes {
+        Plane occupied{}; ///< Fields with a stone.
+        Plane stop{}; ///< Fields with a stone that has a stop.
+        Plane rotatable{}; ///< Fields with a stone that has more than one unique orientation.
+        Plane koLocked{}; ///< Fields with an active ko lock.
+
+        [[nodiscard]] auto operator==(const Planes &other) const -> bool = default;
+    };
 
 public:
     Board() = default;
@@ -55,23 +73,51 @@ public:
         if (isStatic(position) or not stateField(position).canRotate()) {
             throw Error("Tried to rotate static field.");
         }
+        const auto oldKey = fieldKey(position);
         stateField(position).setOrientation(newOrientation);
+        _key ^= oldKey ^ fieldKey(position);
     }
 
     void setField(const Position position, const Stone stone, const Orientation orientation) {
         if (isStatic(position)) {
             throw Error("Tried to change static field.");
         }
+        const auto oldKey = fieldKey(position);
         stateField(position).setStone(stone, orientation);
+        _key ^= oldKey ^ fieldKey(position);
+        updatePlanes(position);
+    }
+
+    /// Restore a field to a previous value, including its ko lock.
+    ///
+    /// This bypasses all game rules and is used to revert moves.
+    ///
+    void restoreField(const Position position, const Field field) {
+        if (isStatic(position)) {
+            throw Error("Tried to change static field.");
+        }
+        const auto oldKey = fieldKey(position);
+        stateField(position) = field;
+        _key ^= oldKey ^ fieldKey(position);
+        updatePlanes(position);
     }
 
     [[nodiscard]] auto rotated(Rotation rotation) const -> Board {
         return Board{_state.rotated(rotation)}; // frame is rotation symmetric.
     }
 
-    [[nodiscard]] auto canPlayerPlaceStone(const Position position) const noexcept -> bool {
-        return not isStatic(position) and field(position).empty() and not (
-            isGarden(position) and playerForField(position) != Player{0});
+    /// Test if a player can place a stone at a position.
+    ///
+    /// @param position The position to test.
+    /// @param perspective The player placing the stone. Player 0, if the board is rotated for the active player.
+    ///
+    [[nodiscard]] auto canPlayerPlaceStone(
+        const Position position,
+        const Player perspective = Player{0}) const noexcept -> bool {
+
+        return not isStatic(position)
+            and not _planes.occupied.test(position)
+            and not foreignGardenPlane(perspective).test(position);
     }
 
     [[nodiscard]] auto canPlayerReplaceStone(
@@ -93,60 +139,125 @@ public:
         return field.isValidChange(field.stone(), newOrientation);
     }
 
-    [[nodiscard]] auto allPlaceOneActionPositions() const noexcept -> PositionList {
-        PositionList result;
-        std::size_t count = 0;
-        for (const auto position : allNonStaticPositions()) {
-            if (canPlayerPlaceStone(position)) {
-                count += 1;
-            }
-        }
-        result.reserve(count);
-        for (auto position : allNonStaticPositions()) {
-            if (canPlayerPlaceStone(position)) {
-                result.push_back(position);
+    [[nodiscard]] auto allPlaceOneActionPositions(const Player perspective = Player{0}) const noexcept -> FieldPositions {
+        return placeOnePlane(perspective).toFixedPositions();
+    }
+
+    [[nodiscard]] auto allReplaceOneActionPositions() const noexcept -> FieldPositions {
+        return replaceOnePlane().toFixedPositions();
+    }
+
+    [[nodiscard]] auto allRotateOneActionPositions() const noexcept -> FieldPositions {
+        return rotateOnePlane().toFixedPositions();
+    }
+
+    [[nodiscard]] auto houseOrbPositions(const Player player) const noexcept -> const BoardFrame::HouseOrbPositions& {
+        return _frame.houseOrbPositions(player);
+    }
+
+    [[nodiscard]] static auto sourceOrbPositions() noexcept -> const BoardFrame::SourceOrbPositions& {
+        return _frame.sourceOrbPositions();
+    }
+
+    void nextTurn() noexcept {
+        // Only fields with a ko lock change, and `forEach` iterates a copy of the plane.
+        _planes.koLocked.forEach([this](const Position position) {
+            auto &field = stateField(position);
+            _key ^= fieldKey(position);
+            field.nextTurn();
+            _key ^= fieldKey(position);
+            if (not field.hasKoLock()) {
+                _planes.koLocked.reset(position);
             }
-        }
-        return result;
+        });
     }
 
-    [[nodiscard]] auto allPlaceTwoActionPositions() const noexcept -> PositionPairList {
-        const auto positions = allPlaceOneActionPositions();
-        return generateAllCombinedPositionPairs(positions);
+    /// The Zobrist key of this board.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key { return _key; }
+
+    /// The Zobrist key of the rotated board, without rotating the board.
+    ///
+    [[nodiscard]] auto zobristKey(const Rotation rotation) const noexcept -> zobrist::Key {
+        if (rotation.wrapToClockwise().isNone()) {
+            return _key;
+        }
+        // Empty fields without a ko lock have no key.
+        zobrist::Key result{};
+        (_planes.occupied | _planes.koLocked).forEach([&](const Position position) {
+            const auto targetIndex = Plane::index(rotatedPosition(rotation, position));
+            result ^= zobrist::fieldKey(targetIndex, stateField(position).rotated(rotation));
+        });
+        return result;
     }
 
-    [[nodiscard]] auto allReplaceOneActionPositions() const noexcept -> PositionList {
-        return allNonStaticPositionsIf([](const Field& field) {
-            return not field.empty() and not field.hasKoLock();
+    /// Revert the ko lock decay of `nextTurn()`.
+    ///
+    /// Fields changed after `nextTurn()` must be restored after calling this method.
+    ///
+    /// @param koLocked The ko-locked fields, before `nextTurn()` was called.
+    ///
+    void revertNextTurn(const Plane &koLocked) noexcept {
+        koLocked.forEach([this](const Position position) {
+            auto &field = stateField(position);
+            _key ^= fieldKey(position);
+            field.setKoLock(field.koLock() + 1);
+            _key ^= fieldKey(position);
+            _planes.koLocked.set(position);
         });
     }
 
-    [[nodiscard]] auto allReplaceTwoActionPositions() const noexcept -> PositionPairList {
-        const auto positions = allReplaceOneActionPositions();
-        return generateAllCombinedPositionPairs(positions);
+public: // bit planes
+    [[nodiscard]] auto planes() const noexcept -> const Planes& { return _planes; }
+
+    /// All fields where a player can place a stone.
+    ///
+    /// @param perspective The active player. Player 0, if the board is rotated for the active player.
+    ///
+    [[nodiscard]] auto placeOnePlane(const Player perspective = Player{0}) const noexcept -> Plane {
+        return dynamicPlane() & ~_planes.occupied & ~foreignGardenPlane(perspective);
     }
 
-    [[nodiscard]] auto allRotateOneActionPositions() const noexcept -> PositionList {
-        return allNonStaticPositionsIf([](const Field& field) { return not field.empty() && field.canRotate(); });
+    /// All fields where the active player can replace a stone.
+    ///
+    /// Ko locks apply to all players alike, so this does not depend on the perspective.
+    ///
+    [[nodiscard]] auto replaceOnePlane() const noexcept -> Plane {
+        return _planes.occupied & ~_planes.koLocked;
     }
 
-    [[nodiscard]] auto allRotateTwoActionPositions() const noexcept -> PositionPairList {
-        const auto positions = allRotateOneActionPositions();
-        return generateAllCombinedPositionPairs(positions);
+    /// All fields where the active player can rotate a stone.
+    ///
+    [[nodiscard]] auto rotateOnePlane() const noexcept -> Plane {
+        return _planes.occupied & _planes.rotatable;
     }
 
-    [[nodiscard]] auto houseOrbPositions(const Player player) const noexcept -> const BoardFrame::HouseOrbPositions& {
-        return _frame.houseOrbPositions(player);
+    /// All fields in the state, that are not static.
+    ///
+    [[nodiscard]] static auto dynamicPlane() noexcept -> const Plane& {
+        static const Plane plane = Plane::from(~_frame.staticMask());
+        return plane;
     }
 
-    [[nodiscard]] static auto sourceOrbPositions() noexcept -> const BoardFrame::SourceOrbPositions& {
-        return _frame.sourceOrbPositions();
+    /// The garden fields of all players except the given one.
+    ///
+    [[nodiscard]] static auto foreignGardenPlane(const Player player) noexcept -> const Plane& {
+        static const std::array<Plane, Player::count> planes = [] {
+            std::array<Plane, Player::count> result{};
+            for (const auto player : Player::all()) {
+                for (const auto otherPlayer : Player::all()) {
+                    if (otherPlayer != player) {
+                        result.at(player) |= Plane::from(_frame.gardenMask(otherPlayer));
+                    }
+                }
+            }
+            return result;
+        }();
+        return planes.at(player);
     }
 
-    void nextTurn() noexcept {
-        for (const auto pos : allNonStaticPositions()) {
-            stateField(pos).nextTurn();
-        }
+    [[nodiscard]] static auto houseMask(const Player player) noexcept -> const Mask& {
+        return _frame.houseMask(player);
     }
 
 public: // serialization
@@ -165,6 +276,43 @@ public: // serialization
         return Board{State::fromData(data)};
     }
 
+public: // binary serialization
+    /// Add the board in its binary form.
+    ///
+    /// The mask of the occupied fields is followed by one byte per occupied field, in position order.
+    /// The lower four bits are the stone, followed by two bits for the orientation and two for the ko lock.
+    ///
+    void addToBinary(std::string &data) const noexcept {
+        _planes.occupied.addToBinary(data);
+        _planes.occupied.forEach([&](const Position position) {
+            const auto field = stateField(position);
+            data += static_cast<char>(
+                static_cast<uint8_t>(field.stone())
+                | static_cast<uint8_t>(field.orientation().value() << 4U)
+                | static_cast<uint8_t>(field.koLock() << 6U));
+        });
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> Board {
+        const auto occupied = Plane::fromBinary(reader);
+        State state;
+        occupied.forEach([&](const Position position) {
+            if (isStatic(position)) {
+                throw Error("Board: Stone on a static field in binary data.");
+            }
+            const auto value = reader.readByte();
+            const auto stoneValue = static_cast<uint8_t>(value & 0x0fU);
+            if (stoneValue == Stone::Empty or stoneValue >= Stone::count) {
+                throw Error("Board: Invalid stone in binary data.");
+            }
+            state.field(position - Position{1, 1}) = Field{
+                Stone{stoneValue},
+                static_cast<Orientation::Value>((value >> 4U) & 0x03U),
+                static_cast<uint8_t>(value >> 6U)};
+        });
+        return Board{state};
+    }
+
 public: // display
     [[nodiscard]] auto toString() const noexcept -> std::string {
         constexpr auto grid = GridOutput{GridOutput::GridBoldBorder, 5, setup::boardSize, setup::boardSize};
@@ -230,7 +378,24 @@ public:
     }
 
 private:
-    explicit Board(const State &state) : _state{state} {};
+    explicit Board(const State &state) : _state{state} {
+        dynamicPlane().forEach([this](const Position position) {
+            updatePlanes(position);
+            _key ^= fieldKey(position);
+        });
+    };
+
+    [[nodiscard]] auto fieldKey(const Position position) const noexcept -> zobrist::Key {
+        return zobrist::fieldKey(Plane::index(position), stateField(position));
+    }
+
+    void updatePlanes(const Position position) noexcept {
+        const auto field = stateField(position);
+        _planes.occupied.assign(position, not field.empty());
+        _planes.stop.assign(position, field.hasStop());
+        _planes.rotatable.assign(position, not field.empty() and field.canRotate());
+        _planes.koLocked.assign(position, field.hasKoLock());
+    }
 
     [[nodiscard]] auto stateField(const Position position) -> Field& {
         if (position.x() < 1 && position.x() > (State::sideLength - 1)) {
@@ -252,74 +417,21 @@ private:
         return _state.field(position - Position{1, 1});
     }
 
-    [[nodiscard]] static auto generateAllPositions() noexcept -> PositionList {
-        PositionList result;
-        result.reserve(setup::boardSize * setup::boardSize);
-        for (Length y = 1; y < setup::boardSize - 1; ++y) {
-            for (Length x = 1; x < setup::boardSize - 1; ++x) {
-                result.emplace_back(x, y);
-            }
-        }
-        return result;
-    }
-
-    [[nodiscard]] static auto allPositions() noexcept -> const PositionList& {
-        static const PositionList positions = generateAllPositions();
-        return positions;
-    }
-
-    [[nodiscard]] static auto allNonStaticPositions() noexcept -> const PositionList& {
-        static const PositionList positions =
-            generateAllPositions()
-            | std::views::filter([](const Position& position) { return not isStatic(position); })
-            | std::ranges::to<std::vector>();
-        return positions;
-    }
-
-    [[nodiscard]] auto allNonStaticPositionsIf(const std::function<bool(const Field&)> &testFn) const noexcept -> PositionList {
-        PositionList result;
-        std::size_t count = 0;
-        for (const auto position : allNonStaticPositions()) {
-            if (testFn(stateField(position))) {
-                count += 1;
-            }
-        }
-        result.reserve(count);
-        for (auto position : allNonStaticPositions()) {
-            // if `stateField` directly, as this saves one necessary test.
-            if (testFn(stateField(position))) {
-                result.push_back(position);
-            }
-        }
-        return result;
-    }
-
-    [[nodiscard]] static auto generateAllCombinedPositionPairs(const PositionList &positions) noexcept -> PositionPairList {
-        if (positions.size() < 2) {
-            return {}; // No pairs possible if fewer than 2 positions
-        }
-        PositionPairList result;
-        result.reserve(positions.size() * (positions.size() - 1) / 2);
-        for (auto it = positions.begin(); it != positions.end(); ++it) {
-            for (auto jt = it + 1; jt != positions.end(); ++jt) {
-                result.emplace_back(*it, *jt);
-            }
-        }
-        return result;
-    }
-
 private:
     static inline BoardFrame _frame{};
     State _state{};
+    Planes _planes{}; ///< Derived from `_state`.
+    zobrist::Key _key{}; ///< Derived from `_state`.
 };
 
 
 static_assert(Serializable<Board>);
+static_assert(BinarySerializable<Board>);
 
 
 template<>
 struct std::hash<Board> {
     auto operator()(const Board &board) const noexcept -> std::size_t {
-        return std::hash<Board::State>{}(board._state);
+        return board.zobristKey();
     }
 };
\ No newline at end of file
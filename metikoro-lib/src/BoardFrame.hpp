@@ -6,6 +6,7 @@
 #include "FrameField.hpp"
 #include "FieldGrid.hpp"
 #include "OrbPositions.hpp"
+#include "PositionMask.hpp"
 
 
 class BoardFrame : public FieldGrid<FrameField, setup::boardSize> {
@@ -15,11 +16,14 @@ public:
     using PlayerHouseOrbPositions = std::array<HouseOrbPositions, Player::count>;
     static constexpr uint8_t sourceOrbCount = 4;
     using SourceOrbPositions = std::array<Position, sourceOrbCount>;
+    using Mask = PositionMask<setup::boardSize>;
+    using PlayerMasks = std::array<Mask, Player::count>;
 
 public:
     BoardFrame() {
-        Player player{0};
-        for (const Rotation rotation : Rotation::allClockwise()) {
+        // The players are placed counter-clockwise around the board, starting at the top-left corner.
+        for (const auto player : Player::all()) {
+            const auto rotation = Rotation{static_cast<Rotation::Value>(-static_cast<int8_t>(player.value()))};
             auto set = [&](Position position, Stone stone, Orientation orientation, BoardArea area) {
                 setFieldRotated(position, stone, orientation, rotation);
                 setAreaRotated(position, area, rotation);
@@ -42,7 +46,7 @@ public:
             set(Position{setup::sourceOffset, setup::sourceOffset},
                 Stone::OneCurveWithStop, Orientation::West, BoardArea::Source);
             // Set the source positions.
-            _sourceOrbPositions[rotation] =
+            _sourceOrbPositions.at(player) =
                 rotatedPosition(rotation, Position{setup::sourceOffset, setup::sourceOffset});
             // Set the orb position to test.
             _houseOrbPositions[player] = {
@@ -56,7 +60,19 @@ public:
                     field(pos).setPlayer(player);
                 }
             }
-            player.next();
+        }
+        // Build the masks for the static areas.
+        for (Length y = 0; y < setup::boardSize; ++y) {
+            for (Length x = 0; x < setup::boardSize; ++x) {
+                const auto pos = Position{x, y};
+                const auto &frameField = field(pos);
+                _staticMask.assign(pos, frameField.isStatic());
+                if (frameField.area() == BoardArea::House) {
+                    _houseMasks.at(frameField.player()).set(pos);
+                } else if (frameField.area() == BoardArea::Garden) {
+                    _gardenMasks.at(frameField.player()).set(pos);
+                }
+            }
         }
     }
 
@@ -71,9 +87,15 @@ public:
     [[nodiscard]] auto houseOrbPositions(const Player player) const noexcept -> const HouseOrbPositions& {
         return _houseOrbPositions.at(player);
     }
+    [[nodiscard]] auto staticMask() const noexcept -> const Mask& { return _staticMask; }
+    [[nodiscard]] auto houseMask(const Player player) const noexcept -> const Mask& { return _houseMasks.at(player); }
+    [[nodiscard]] auto gardenMask(const Player player) const noexcept -> const Mask& { return _gardenMasks.at(player); }
 
 private:
     PlayerHouseOrbPositions _houseOrbPositions{};
     SourceOrbPositions _sourceOrbPositions{};
+    Mask _staticMask{}; ///< All frame, house and source fields.
+    PlayerMasks _houseMasks{}; ///< The house fields for each player.
+    PlayerMasks _gardenMasks{}; ///< The garden fields for each player.
 };
 
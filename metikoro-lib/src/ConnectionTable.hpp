@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Anchors.hpp"
+#include "Orientation.hpp"
+#include "Stone.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+/// Precompiled connections of all stones.
+///
+/// For every stone, orientation and entry anchor, the table holds the exit anchors of the placed stone.
+/// It replaces normalizing the anchor, looking up the wiring and rotating the result back, which is the
+/// innermost step of the orb travel calculation.
+///
+namespace connection {
+
+
+/// The number of entries in the table.
+///
+constexpr std::size_t tableSize = static_cast<std::size_t>(Stone::count) * Orientation::count * Anchor::count;
+
+
+/// The index of the connections for a stone with the given orientation and entry anchor.
+///
+[[nodiscard]] constexpr auto index(const Stone stone, const Orientation orientation, const Anchor entry) noexcept -> std::size_t {
+    return (static_cast<std::size_t>(stone.type()) * Orientation::count + orientation.value()) * Anchor::count + entry.value();
+}
+
+
+/// The exit anchors for all stones, orientations and entry anchors.
+///
+inline constexpr auto table = [] {
+    const auto wiring = Stone::createWiring();
+    std::array<Anchors, tableSize> result{};
+    for (uint8_t stone = 0; stone < Stone::count; ++stone) {
+        for (uint8_t orientationIndex = 0; orientationIndex < Orientation::count; ++orientationIndex) {
+            const auto orientation = Orientation{static_cast<Orientation::Value>(orientationIndex)};
+            for (uint8_t entryIndex = 0; entryIndex < Anchor::count; ++entryIndex) {
+                const auto entry = Anchor{static_cast<Anchor::Value>(entryIndex)};
+                result[index(Stone{stone}, orientation, entry)] =
+                    wiring[stone].connections[entry.normalized(orientation).value()].rotated(orientation);
+            }
+        }
+    }
+    return result;
+}();
+
+
+/// Get the exit anchors for a stone with the given orientation, entered at the given anchor.
+///
+[[nodiscard]] constexpr auto exitsFrom(const Stone stone, const Orientation orientation, const Anchor entry) noexcept -> Anchors {
+    return table[index(stone, orientation, entry)];
+}
+
+
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 
+#include "ConnectionTable.hpp"
 #include "Orientation.hpp"
 #include "Stone.hpp"
 
@@ -67,8 +68,8 @@ public: // Stone wrapper
     [[nodiscard]] auto empty() const noexcept -> bool { return stone().empty(); }
     [[nodiscard]] auto hasStop() const noexcept -> bool { return stone().hasStop();}
 
-    [[nodiscard]] auto connectionsFrom(const Anchor connectionPoint) const -> Anchors {
-        return stone().connectionsFrom(connectionPoint.normalized(orientation())).rotated(orientation());
+    [[nodiscard]] auto connectionsFrom(const Anchor connectionPoint) const noexcept -> Anchors {
+        return connection::exitsFrom(stone(), orientation(), connectionPoint);
     }
     [[nodiscard]] auto uniqueOrientations() const noexcept -> Orientations {
         return stone().uniqueOrientations();
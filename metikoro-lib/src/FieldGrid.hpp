@@ -48,7 +48,7 @@ public:
         field(position).setStone(stone, orientation);
     }
     void setFieldRotated(const Position position, const Stone stone, const Orientation orientation, const Rotation rotation) noexcept {
-        field(rotatedPosition(rotation, position)).setStone(stone, orientation - rotation);
+        field(rotatedPosition(rotation, position)).setStone(stone, orientation + rotation);
     }
     void rotateField(const Position position, const Rotation rotation) {
         field(position).rotate(rotation);
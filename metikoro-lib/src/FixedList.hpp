@@ -0,0 +1,86 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Error.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/// A list with a fixed capacity, that stores its elements inline.
+///
+/// Used for the short lists created while generating moves, where the maximum size is known at compile time.
+/// Creating, filling and destroying the list never allocates memory.
+///
+template<typename T, std::size_t N>
+class FixedList {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = typename std::array<T, N>::iterator;
+    using const_iterator = typename std::array<T, N>::const_iterator;
+
+public:
+    constexpr FixedList() = default;
+
+public: // comparison
+    [[nodiscard]] constexpr auto operator==(const FixedList &other) const noexcept -> bool {
+        return std::ranges::equal(*this, other);
+    }
+    [[nodiscard]] constexpr auto operator==(const std::vector<T> &other) const noexcept -> bool {
+        return std::ranges::equal(*this, other);
+    }
+
+public: // access
+    [[nodiscard]] static constexpr auto capacity() noexcept -> std::size_t { return N; }
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return _size; }
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool { return _size == 0; }
+    [[nodiscard]] constexpr auto begin() noexcept -> iterator { return _elements.begin(); }
+    [[nodiscard]] constexpr auto end() noexcept -> iterator { return _elements.begin() + _size; }
+    [[nodiscard]] constexpr auto begin() const noexcept -> const_iterator { return _elements.begin(); }
+    [[nodiscard]] constexpr auto end() const noexcept -> const_iterator { return _elements.begin() + _size; }
+
+    [[nodiscard]] constexpr auto operator[](const std::size_t index) const noexcept -> const T& {
+        assert(index < _size);
+        return _elements[index];
+    }
+    [[nodiscard]] constexpr auto at(const std::size_t index) const -> const T& {
+        if (index >= _size) {
+            throw Error("FixedList: Index out of range.");
+        }
+        return _elements[index];
+    }
+
+public: // modification
+    constexpr void clear() noexcept { _size = 0; }
+
+    constexpr void push_back(const T &value) noexcept {
+        assert(_size < N);
+        _elements[_size++] = value;
+    }
+
+    template<typename... Args>
+    constexpr void emplace_back(Args&&... args) noexcept {
+        assert(_size < N);
+        _elements[_size++] = T{std::forward<Args>(args)...};
+    }
+
+    /// Remove all elements that match a predicate, keeping the order of the others.
+    ///
+    template<typename Pred>
+    constexpr friend void erase_if(FixedList &list, Pred pred) noexcept {
+        const auto newEnd = std::remove_if(list.begin(), list.end(), pred);
+        list._size = static_cast<std::size_t>(newEnd - list.begin());
+    }
+
+private:
+    std::array<T, N> _elements{};
+    std::size_t _size{0};
+};
+
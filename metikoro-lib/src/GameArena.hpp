@@ -0,0 +1,85 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+
+/// A monotonic arena for the temporary containers of one game.
+///
+/// Move generators and agents allocate their temporary containers from the active arena of the calling
+/// thread. Deallocation is a no-op, and all memory is released at once when the game ends. The released
+/// memory is kept in a pool, so an arena that is reused for many games stops allocating from the heap.
+///
+/// Containers from the arena must not outlive the game. Without an active arena, the containers use the
+/// heap as usual.
+///
+class GameArena {
+public:
+    /// The size of the first buffer of the arena.
+    constexpr static std::size_t initialSize = 64 * 1024;
+
+    /// The largest buffer that is kept in the pool, when the arena is released.
+    constexpr static std::size_t largestPooledSize = 4 * 1024 * 1024;
+
+    /// Activates an arena for the calling thread, while the scope exists.
+    ///
+    /// Scopes can be nested, the previous arena is restored when the scope ends.
+    ///
+    class Scope {
+    public:
+        explicit Scope(GameArena &arena) noexcept : _previous{std::exchange(_current, &arena)} {}
+        ~Scope() { _current = _previous; }
+
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+
+    private:
+        GameArena *_previous; ///< The arena that was active before this scope.
+    };
+
+public:
+    GameArena()
+        : _initialBuffer{std::make_unique<std::byte[]>(initialSize)},
+          _pool{std::pmr::pool_options{.max_blocks_per_chunk = 1, .largest_required_pool_block = largestPooledSize}},
+          _arena{_initialBuffer.get(), initialSize, &_pool} {
+    }
+
+    GameArena(const GameArena&) = delete;
+    auto operator=(const GameArena&) -> GameArena& = delete;
+
+public:
+    /// The memory resource of this arena.
+    ///
+    [[nodiscard]] auto resource() noexcept -> std::pmr::memory_resource* { return &_arena; }
+
+    /// Release all memory allocated from this arena.
+    ///
+    /// All containers that were allocated from the arena must be destroyed before.
+    ///
+    void release() noexcept { _arena.release(); }
+
+    /// The active arena of the calling thread, or `nullptr` if there is none.
+    ///
+    [[nodiscard]] static auto current() noexcept -> GameArena* { return _current; }
+
+    /// The memory resource for temporary containers in the calling thread.
+    ///
+    /// @return The resource of the active arena, or the heap if there is no active arena.
+    ///
+    [[nodiscard]] static auto currentResource() noexcept -> std::pmr::memory_resource* {
+        return _current != nullptr ? _current->resource() : std::pmr::new_delete_resource();
+    }
+
+private:
+    static inline thread_local GameArena *_current{nullptr};
+
+    std::unique_ptr<std::byte[]> _initialBuffer; ///< The first buffer, that is never released.
+    std::pmr::unsynchronized_pool_resource _pool; ///< Keeps the larger buffers between games.
+    std::pmr::monotonic_buffer_resource _arena; ///< The arena.
+};
+
@@ -6,92 +6,194 @@
 #include "GameTurn.hpp"
 #include "RatingAdjustment.hpp"
 
+#include <cassert>
+#include <iterator>
 #include <list>
 
 
 
 /// The log of a complete game.
 ///
+/// The log only stores the move and the active player of each turn. The states of the turns are
+/// reconstructed by replaying the moves, starting from keyframes with the full state, that are stored every
+/// `keyframeInterval` turns. The turn number is the index of the turn in the log.
+///
 class GameLog {
     constexpr static std::size_t usualMaxTurns = 256;
 
 public:
-    using GameTurns = std::vector<GameTurn>;
+    /// The number of turns between two stored states.
+    constexpr static std::size_t keyframeInterval = 32;
+
+    /// An iterator over the turns of the log, that replays the moves.
+    ///
+    /// The turn is kept in the iterator, so references to it are only valid until the iterator is advanced.
+    ///
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = GameTurn;
+        using difference_type = std::ptrdiff_t;
+        using reference = const GameTurn&;
+        using pointer = const GameTurn*;
+
+    public:
+        Iterator() = default;
+        Iterator(const GameLog *gameLog, const std::size_t index) : _gameLog{gameLog}, _index{index} {
+            if (_index < _gameLog->size()) {
+                _turn = _gameLog->turn(_index);
+            }
+        }
+
+    public:
+        [[nodiscard]] auto operator*() const noexcept -> const GameTurn& { return _turn; }
+        [[nodiscard]] auto operator->() const noexcept -> const GameTurn* { return &_turn; }
+        [[nodiscard]] auto operator==(const Iterator &other) const noexcept -> bool { return _index == other._index; }
+        auto operator++() -> Iterator& {
+            _index += 1;
+            if (_index < _gameLog->size()) {
+                _gameLog->advanceTurn(_turn);
+            }
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+    private:
+        const GameLog *_gameLog{nullptr}; ///< The iterated log.
+        std::size_t _index{0}; ///< The index of the current turn.
+        GameTurn _turn{}; ///< The current turn.
+    };
 
 public:
     GameLog() = default;
 
 public: // accessors
-    [[nodiscard]] auto turns() const noexcept -> const GameTurns& {
-        return _turns;
-    }
     [[nodiscard]] auto size() const noexcept -> std::size_t {
-        return _turns.size();
+        return _entries.size();
     }
     [[nodiscard]] auto empty() const noexcept -> bool {
-        return _turns.empty();
+        return _entries.empty();
+    }
+    [[nodiscard]] auto begin() const -> Iterator {
+        return Iterator{this, 0};
+    }
+    [[nodiscard]] auto end() const noexcept -> Iterator {
+        return Iterator{this, size()};
     }
-    [[nodiscard]] auto begin() const noexcept -> GameTurns::const_iterator {
-        return _turns.begin();
+
+    /// Get a turn, with the state reconstructed from the nearest keyframe.
+    ///
+    /// @param index The index of the turn, less than `size()`.
+    ///
+    [[nodiscard]] auto turn(const std::size_t index) const -> GameTurn {
+        if (index >= size()) {
+            throw Error("GameLog::turn(): Index out of range.");
+        }
+        if (index + 1 == size()) {
+            return createTurn(index, _lastState);
+        }
+        auto result = createTurn(index / keyframeInterval * keyframeInterval, _keyframes[index / keyframeInterval]);
+        while (result.turn < index) {
+            advanceTurn(result);
+        }
+        return result;
     }
-    [[nodiscard]] auto end() const noexcept -> GameTurns::const_iterator {
-        return _turns.end();
+
+    /// Get the state of the last turn, without replaying the moves.
+    ///
+    /// Only valid, if the log is not empty.
+    ///
+    [[nodiscard]] auto lastState() const noexcept -> const GameState& {
+        return _lastState;
     }
 
 public: // modifiers
+    /// Remove all turns, but keep the capacity, to reuse the log for the next game.
+    ///
+    void clear() noexcept {
+        _entries.clear();
+        _keyframes.clear();
+    }
     void addTurn(const GameTurn &turn) noexcept {
-        if (_turns.empty()) {
-            _turns.reserve(usualMaxTurns);
-        }
-        _turns.emplace_back(turn);
+        addTurn(turn.turn, turn.activePlayer, turn.state, turn.gameMove);
     }
+
+    /// Add a turn.
+    ///
+    /// @param turn The turn number, that must be the current size of the log.
+    /// @param player The active player.
+    /// @param gameState The state before the move, in its original position.
+    /// @param gameMove The move of the player.
+    ///
     void addTurn(
-        const std::size_t turn,
+        [[maybe_unused]] const std::size_t turn,
         const Player player,
         const GameState &gameState,
         const GameMove &gameMove) noexcept {
 
-        if (_turns.empty()) {
-            _turns.reserve(usualMaxTurns);
+        assert(turn == _entries.size());
+        if (_entries.empty()) {
+            _entries.reserve(usualMaxTurns);
+            _keyframes.reserve(usualMaxTurns / keyframeInterval + 1);
         }
-        _turns.emplace_back(turn, player, gameState, gameMove);
+        if (_entries.size() % keyframeInterval == 0) {
+            _keyframes.emplace_back(gameState);
+        }
+        _entries.emplace_back(player, gameMove);
+        _lastState = gameState;
     }
     void addLastState(
         const std::size_t turn,
         const Player player,
         const GameState &gameState) noexcept {
 
-        _turns.emplace_back(turn, player, gameState, GameMove{});
+        addTurn(turn, player, gameState, GameMove{});
     }
 
 public: // game analysis
     [[nodiscard]] auto winningPlayer() const -> std::optional<Player> {
-        if (_turns.size() < 2) {
+        if (_entries.size() < 2) {
             return std::nullopt;
         }
-        const auto &lastState = _turns.back().state;
-        if (const auto winningPlayer = lastState.winningPlayer()) {
-            const auto playerExecutedWinningMove = (_turns.end() - 2)->activePlayer;
-            return playerExecutedWinningMove.offsetWith(winningPlayer.value());
-        }
-        return std::nullopt;
+        // The states are kept in their original position, so the house owners are the actual players.
+        return _lastState.winningPlayer();
     }
     [[nodiscard]] auto createRatingAdjustments() const noexcept -> RatingAdjustments {
         const auto winningPlayer = this->winningPlayer();
         const auto totalTurnCount = size();
         RatingAdjustments result;
-        result.reserve(_turns.size());
-        std::ranges::transform(
-            _turns,
-            std::back_inserter(result),
-            [winningPlayer, totalTurnCount](const GameTurn &turn) {
-                return RatingAdjustment(turn, totalTurnCount, winningPlayer);
-            }
-        );
+        result.reserve(_entries.size());
+        for (std::size_t i = 0; i < _entries.size(); ++i) {
+            result.emplace_back(i, _entries[i].activePlayer, totalTurnCount, winningPlayer);
+        }
         return result;
     }
 
 private:
-    GameTurns _turns;
+    /// The recorded data of one turn.
+    ///
+    struct Entry {
+        Player activePlayer; ///< The active player of this turn.
+        GameMove gameMove; ///< The move of the player, or no move to mark the end of the game.
+    };
+
+    [[nodiscard]] auto createTurn(const std::size_t index, const GameState &state) const noexcept -> GameTurn {
+        return GameTurn{index, _entries[index].activePlayer, state, _entries[index].gameMove};
+    }
+
+    /// Advance a turn to the next turn, by executing its move.
+    ///
+    void advanceTurn(GameTurn &turn) const {
+        turn.state.executeMove(turn.gameMove, turn.activePlayer);
+        turn.turn += 1;
+        turn.activePlayer = _entries[turn.turn].activePlayer;
+        turn.gameMove = _entries[turn.turn].gameMove;
+    }
+
+private:
+    std::vector<Entry> _entries; ///< The active player and move of each turn.
+    std::vector<GameState> _keyframes; ///< The state of every `keyframeInterval`-th turn.
+    GameState _lastState; ///< The state of the last turn.
 };
 
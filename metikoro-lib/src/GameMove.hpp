@@ -27,6 +27,13 @@ public: // attributes
     [[nodiscard]] auto drawnStone() const noexcept -> Stone { return _drawnStone; }
     [[nodiscard]] auto orbMove() const noexcept -> const OrbMove& { return _orbMove; }
 
+public: // methods
+    /// Create a rotated version of this move, matching a rotated state.
+    ///
+    [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> GameMove {
+        return GameMove{_actions.rotated(rotation), _drawnStone, _orbMove.rotated(rotation)};
+    }
+
 public: // serialization
     [[nodiscard]] auto toData() const noexcept -> std::string {
         std::string result;
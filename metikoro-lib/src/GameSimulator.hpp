@@ -7,8 +7,11 @@
 #include "GameResult.hpp"
 #include "Player.hpp"
 #include "Agent.hpp"
+#include "StateKeyTable.hpp"
 
-#include <unordered_set>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
 
 
 
@@ -22,17 +25,22 @@ public:
 public:
     /// Run the simulation
     ///
-    /// @return The final state, rotated to match the original player arrangement.
+    /// The state is kept in its original position for the whole game, and the active player is passed as
+    /// perspective. It is only rotated if an agent requests the view of its player.
+    ///
+    /// A simulator can run many games. Each run resets the simulator first, and reuses the memory of the
+    /// previous game.
+    ///
+    /// @return The final state, in the original player arrangement.
     ///
     auto run() -> GameState {
-        _state = GameState::createStartingGameState();
-        _currentPlayer = Player{0};
+        reset();
         std::size_t loopCount = 0;
         std::size_t turnCount = 0;
         while (not _state.hasWinner() and loopCount < setup::loopCountForDraw) {
-            auto nextMove = _agents.at(_currentPlayer)->nextMove(_state, _gameLog);
+            auto nextMove = _agents.at(_currentPlayer)->nextMoveForPlayer(_state, _currentPlayer, _gameLog);
             _gameLog.addTurn(turnCount, _currentPlayer, _state, nextMove);
-            _state.executeMove(nextMove);
+            _state.executeMove(nextMove, _currentPlayer);
             turnCount += 1; // Just after executing the move, the turn ended and a new turn began.
             if (_state.hasWinner()) {
                 if (_progressFn) {
@@ -43,9 +51,9 @@ public:
             if (_progressFn) {
                 _progressFn(_currentPlayer, _state, _gameLog, GameResult::None, loopCount);
             }
-            _state = _state.rotated(Rotation::Clockwise90);
             _currentPlayer.next();
-            if (_states.contains(_state)) {
+            // The same state is only a repetition, if the same player is active.
+            if (isRepetition()) {
                 if (++loopCount > setup::loopCountForDraw) {
                     if (_progressFn) {
                         _progressFn(_currentPlayer, _state, _gameLog, GameResult::Draw, loopCount);
@@ -53,10 +61,26 @@ public:
                     break;
                 }
             }
-            _states.insert(_state);
         }
         _gameLog.addLastState(turnCount, _currentPlayer, _state);
-        return _state.rotatedForPlayer(_currentPlayer);
+        return _state;
+    }
+
+    /// Reset the simulator to the start of a new game.
+    ///
+    /// The game log and the recorded states are cleared, but keep their memory for the next game.
+    ///
+    void reset() {
+        _state = GameState::createStartingGameState();
+        _currentPlayer = Player{0};
+        _gameLog.clear();
+        for (auto &stateKeys : _stateKeys) {
+            stateKeys.clear();
+        }
+        for (auto &verifiedStates : _verifiedStates) {
+            verifiedStates.clear();
+        }
+        _keyCollisionCount = 0;
     }
 
     /// Set a progress function.
@@ -65,17 +89,60 @@ public:
         _progressFn = progressFn;
     }
 
+    /// Compare the full states, if a state key repeats.
+    ///
+    /// Repetitions are detected by the 64-bit Zobrist keys of the states. With verification, the full states
+    /// are kept as well, and a repeated key only counts as repetition if one of the states with this key is
+    /// equal. A different state with the same key is recorded as well, so its repetitions are detected.
+    ///
+    void setVerifyRepetitions(const bool verify) noexcept {
+        _verifyRepetitions = verify;
+    }
+
+    /// The number of repeated keys with different states, found by the verification in the last game.
+    ///
+    [[nodiscard]] auto keyCollisionCount() const noexcept -> std::size_t {
+        return _keyCollisionCount;
+    }
+
     /// Access the complete game history.
     ///
     [[nodiscard]] auto gameLog() const -> const GameLog& {
         return _gameLog;
     }
 
+private:
+    /// Record the current state for the current player, and test if it was already recorded.
+    ///
+    [[nodiscard]] auto isRepetition() -> bool {
+        const auto key = _state.zobristKey();
+        if (_stateKeys.at(_currentPlayer).insert(key)) {
+            if (_verifyRepetitions) {
+                _verifiedStates.at(_currentPlayer).emplace(key, _state);
+            }
+            return false;
+        }
+        if (not _verifyRepetitions) {
+            return true;
+        }
+        auto &verifiedStates = _verifiedStates.at(_currentPlayer);
+        const auto [first, last] = verifiedStates.equal_range(key);
+        if (std::any_of(first, last, [this](const auto &entry) { return entry.second == _state; })) {
+            return true;
+        }
+        _keyCollisionCount += 1;
+        verifiedStates.emplace(key, _state);
+        return false;
+    }
+
 private:
     GameState _state; ///< The current state.
     Player _currentPlayer; ///< The current player.
     PlayerAgents _agents; ///< The agents playing the game.
     GameLog _gameLog; ///< The game moves so far.
-    std::unordered_set<GameState> _states; ///< Previously encountered game states.
+    std::array<StateKeyTable, Player::count> _stateKeys; ///< The keys of previously encountered states, per active player.
+    bool _verifyRepetitions{false}; ///< If repeated keys are verified with the full states.
+    std::array<std::unordered_multimap<zobrist::Key, GameState>, Player::count> _verifiedStates; ///< The states for verification, per key.
+    std::size_t _keyCollisionCount{0}; ///< The number of detected key collisions.
     ProgressFn _progressFn{}; ///< A progress function to report the current progress of the simulation.
 };
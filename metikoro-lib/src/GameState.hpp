@@ -9,6 +9,8 @@
 #include "Error.hpp"
 #include "GameMove.hpp"
 #include "GridOutput.hpp"
+#include "MoveUndo.hpp"
+#include "OrbMoveCache.hpp"
 #include "OrbMoves.hpp"
 #include "OrbPositions.hpp"
 #include "Player.hpp"
@@ -18,7 +20,6 @@
 
 
 class GameState {
-    friend struct std::hash<GameState>;
     using MoveAddFn = std::function<void(const GameMove&)>;
 
 public:
@@ -41,6 +42,44 @@ public: // attributes
     [[nodiscard]] auto resourcePool() const noexcept -> const ResourcePool& { return _resourcePool; }
     [[nodiscard]] auto resourcePool() noexcept -> ResourcePool& { return _resourcePool; }
 
+    /// The Zobrist key of this state.
+    ///
+    /// Each part of the state maintains its own key with every change, so this is a constant time operation.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key {
+        return _board.zobristKey() ^ _actionPools.zobristKey() ^ _orbPositions.zobristKey() ^ _resourcePool.zobristKey();
+    }
+
+    /// The Zobrist key of this state after a rotation.
+    ///
+    /// This is identical to `rotated(rotation).zobristKey()`, but without creating the rotated state.
+    ///
+    [[nodiscard]] auto zobristKey(const Rotation rotation) const noexcept -> zobrist::Key {
+        return _board.zobristKey(rotation) ^ _actionPools.zobristKey(rotation) ^ _orbPositions.zobristKey(rotation)
+            ^ _resourcePool.zobristKey();
+    }
+
+    /// Get the rotation into the canonical form of this state.
+    ///
+    /// All four rotations of a state are the same position on the board. The canonical form is the rotation
+    /// with the smallest Zobrist key, so all rotations of a state share the same canonical form. After the
+    /// rotation, the player at the top-left corner is the player rotated there, so ratings of the state have
+    /// to be permuted using `Rating::rotate()` with the same rotation.
+    ///
+    /// @return The rotation to apply to this state, to get the canonical form.
+    ///
+    [[nodiscard]] auto canonicalRotation() const noexcept -> Rotation {
+        auto result = Rotation{Rotation::None};
+        auto smallestKey = zobristKey();
+        for (const auto rotation : {Rotation::Clockwise90, Rotation::Clockwise180, Rotation::Clockwise270}) {
+            if (const auto key = zobristKey(rotation); key < smallestKey) {
+                smallestKey = key;
+                result = rotation;
+            }
+        }
+        return result;
+    }
+
 public:
     [[nodiscard]] auto hasWinner() const noexcept -> bool {
         const auto orbsInHouse = this->orbsInHouse();
@@ -62,35 +101,77 @@ public:
     [[nodiscard]] auto orbsInHouse() const noexcept -> std::array<uint8_t, Player::count> {
         std::array<uint8_t, Player::count> result = {0, 0, 0, 0};
         for (auto player : Player::all()) {
-            for (auto pos : _board.houseOrbPositions(player)) {
-                if (_orbPositions.isOrbAt(pos)) {
-                    ++result.at(player);
-                }
-            }
+            result.at(player) = static_cast<uint8_t>((_orbPositions.mask() & Board::houseMask(player)).count());
         }
         return result;
     }
 
-    void executeMove(const GameMove &move) {
+    /// Execute a move for the active player.
+    ///
+    /// This starts the next turn, applies the actions, draws the stone and moves the orb.
+    ///
+    /// @param move The move to execute.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @return The information to revert this move using `undo()`.
+    ///
+    auto executeMove(const GameMove &move, const Player perspective = Player{0}) -> MoveUndo {
+        auto undo = createUndo(move.actions(), perspective);
+        undo.hasNextTurn = true;
+        undo.koLocked = _board.planes().koLocked;
         nextTurn();
-        move.actions().applyTo(*this);
+        move.actions().applyTo(*this, perspective);
         if (not move.drawnStone().empty()) {
-            moveStoneToPlayer(move.drawnStone(), Player{0});
+            moveStoneToPlayer(move.drawnStone(), perspective);
         }
         if (not move.orbMove().isNoMove()) {
             move.orbMove().applyTo(*this);
         }
+        return undo;
     }
 
-    [[nodiscard]] auto afterAction(const ActionSequence &actionSequence) const noexcept -> GameState {
+    /// Apply a sequence of actions for the active player.
+    ///
+    /// @param actionSequence The actions to apply.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @return The information to revert the actions using `undo()`.
+    ///
+    auto executeActions(const ActionSequence &actionSequence, const Player perspective = Player{0}) -> MoveUndo {
+        auto undo = createUndo(actionSequence, perspective);
+        actionSequence.applyTo(*this, perspective);
+        return undo;
+    }
+
+    /// Revert a move or action sequence.
+    ///
+    /// The undo record must be the one returned by the last call of `executeMove()` or `executeActions()`
+    /// on this state. Records of multiple calls have to be reverted in reverse order.
+    ///
+    void undo(const MoveUndo &undo) {
+        // The changed fields were captured before the ko locks decayed, so they are restored last.
+        if (undo.hasNextTurn) {
+            _board.revertNextTurn(undo.koLocked);
+        }
+        for (auto i = undo.changedFieldCount; i > 0; --i) {
+            const auto &[position, field] = undo.changedFields.at(i - 1);
+            _board.restoreField(position, field);
+        }
+        _actionPools[undo.player] = undo.actionPool;
+        _resourcePool = undo.resourcePool;
+        _orbPositions = undo.orbPositions;
+    }
+
+    [[nodiscard]] auto afterAction(
+        const ActionSequence &actionSequence,
+        const Player perspective = Player{0}) const noexcept -> GameState {
+
         auto temporaryState = *this;
-        actionSequence.applyTo(temporaryState);
+        actionSequence.applyTo(temporaryState, perspective);
         return temporaryState;
     }
 
-    [[nodiscard]] auto afterMove(const GameMove &move) const noexcept -> GameState {
+    [[nodiscard]] auto afterMove(const GameMove &move, const Player perspective = Player{0}) const noexcept -> GameState {
         auto temporaryState = *this;
-        temporaryState.executeMove(move);
+        temporaryState.executeMove(move, perspective);
         return temporaryState;
     }
 
@@ -103,7 +184,9 @@ public:
         _orbPositions.nextTurn();
     }
 
-    /// Create a rotated version of this board.
+    /// Create a rotated version of this state.
+    ///
+    /// The action pools are rotated with the board, so the player at the top-left corner keeps the first pool.
     ///
     [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> GameState {
         return GameState{
@@ -132,34 +215,100 @@ public:
         }
     }
 
+    /// Rotate the state from its original position into the view of a given player.
+    ///
+    /// This is the inverse of `rotatedForPlayer()`. States in the original position are used by the
+    /// simulation, where the active player is passed as perspective. Agents and backends expect the view
+    /// where the active player is at the top-left corner.
+    ///
+    /// @param player The player that shall be at the top-left corner.
+    /// @return The state, rotated that this player is player 0.
+    ///
+    [[nodiscard]] auto rotatedToPlayer(const Player player) const noexcept -> GameState {
+        if (player == Player{0}) {
+            return *this;
+        }
+        return rotated(rotationToPlayer(player));
+    }
+
+    /// Get the rotation from the original position into the view of a given player.
+    ///
+    [[nodiscard]] static auto rotationToPlayer(const Player player) noexcept -> Rotation {
+        return Rotation{static_cast<Rotation::Value>(player.value())};
+    }
+
     /// Generate all possible moves for this state.
     ///
-    [[nodiscard]] auto allMoves() const noexcept -> GameMoves {
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are used for the moves.
+    ///
+    [[nodiscard]] auto allMoves(
+        const Player perspective = Player{0},
+        const ActionSequences::Mode mode = ActionSequences::Mode::All) const noexcept -> GameMoves {
+
         GameMoves moves;
-        auto actionSequences = allActions().actions();
-        for (const auto &actionSeq : actionSequences) {
-            auto stateAfterAction = afterAction(actionSeq);
-            for (const auto drawStone : stateAfterAction.allRegularDraws()) {
-                for (const auto orbMove : stateAfterAction.allOrbMoves()) {
-                    moves.emplace_back(actionSeq, drawStone, orbMove);
+        forEachMove([&moves](const GameMove &move) { moves.push_back(move); }, perspective, mode);
+        return moves;
+    }
+
+    /// Call a function for each possible move for this state, without creating a list of all moves.
+    ///
+    /// The moves are generated on demand, in the same order as `allMoves()`. One working copy of the state is
+    /// used, where each action sequence is executed and reverted. Stop the iteration early, to sample a few
+    /// moves or search for a specific one.
+    ///
+    /// @param fn The visitor, called with each move. If it returns `bool`, `false` stops the iteration.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are used for the moves.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    auto forEachMove(
+        Fn &&fn,
+        const Player perspective = Player{0},
+        const ActionSequences::Mode mode = ActionSequences::Mode::All) const -> bool {
+
+        auto workingState = *this;
+        // The actions do not move orbs, so only the orbs passing a changed field are searched again.
+        auto orbMoveCache = OrbMoveCache{_board, _orbPositions, perspective};
+        return ActionSequences::forEachForState(*this, [&](const ActionSequence &actionSeq) -> bool {
+            const auto undo = workingState.executeActions(actionSeq, perspective);
+            const auto &orbMoves = orbMoveCache.orbMoves(workingState.board(), undo.changedPositions());
+            bool running = true;
+            for (const auto drawStone : workingState.allRegularDraws(perspective)) {
+                for (const auto &orbMove : orbMoves) {
+                    if (not utility::callVisitor(fn, GameMove{actionSeq, drawStone, orbMove})) {
+                        running = false;
+                        break;
+                    }
+                }
+                if (not running) {
+                    break;
                 }
             }
-        }
-        return moves;
+            workingState.undo(undo);
+            return running;
+        }, perspective, mode);
     }
 
     /// Get all possible action sequences from the current state of the game.
     ///
-    [[nodiscard]] auto allActions() const noexcept -> ActionSequences {
-        return ActionSequences::allForState(*this);
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param mode Which action sequences are generated.
+    ///
+    [[nodiscard]] auto allActions(
+        const Player perspective = Player{0},
+        const ActionSequences::Mode mode = ActionSequences::Mode::All) const noexcept -> ActionSequences {
+
+        return ActionSequences::allForState(*this, perspective, mode);
     }
 
     /// Get all possible regular draws for the current state.
     ///
     /// Make sure you apply the chosen action(s), before you call this method.
     ///
-    [[nodiscard]] auto allRegularDraws() const noexcept -> StoneList {
-        if (actionPools().active().full()) {
+    [[nodiscard]] auto allRegularDraws(const Player perspective = Player{0}) const noexcept -> ResourcePool::Draws {
+        if (actionPools()[perspective].full()) {
             return {};
         }
         return _resourcePool.allRegularDraws();
@@ -169,11 +318,28 @@ public:
     ///
     /// Make sure you apply the chose action(s), before calling this method.
     ///
-    [[nodiscard]] auto allOrbMoves() const noexcept -> OrbMoves {
-        return OrbMoves::allForState(*this);
+    [[nodiscard]] auto allOrbMoves(const Player perspective = Player{0}) const noexcept -> OrbMoves {
+        return OrbMoves::allForState(*this, perspective);
     }
 
 private:
+    [[nodiscard]] auto createUndo(const ActionSequence &actionSequence, const Player perspective) const -> MoveUndo {
+        MoveUndo undo{
+            .player = perspective,
+            .actionPool = _actionPools[perspective],
+            .resourcePool = _resourcePool,
+            .orbPositions = _orbPositions,
+        };
+        for (const auto &action : actionSequence.sequence()) {
+            if (action.isNone() or action.type() == Action::DrawStone) {
+                continue;
+            }
+            undo.changedFields.at(undo.changedFieldCount) = {action.position(), _board.field(action.position())};
+            undo.changedFieldCount += 1;
+        }
+        return undo;
+    }
+
     void moveStoneToPlayer(const Stone stone, const Player player) {
         if (not _resourcePool.hasStone(stone)) {
             throw Error("Not enough stones in resource pool to move one to the player.");
@@ -241,6 +407,51 @@ public: // serialization
         return GameState{board, actionPools, orbPositions, resourcePool};
     }
 
+public: // binary serialization
+    /// The version of the binary form, stored in the first byte.
+    ///
+    static constexpr uint8_t binaryVersion = 1;
+
+    /// Create the compact binary form of this state.
+    ///
+    /// The binary form has a variable size, depending on the number of stones on the board, and is
+    /// usually between 40 and 80 bytes. Like `toData()`, it is unique for each state and can be used as key.
+    ///
+    [[nodiscard]] auto toBinary() const noexcept -> std::string {
+        std::string data;
+        data.reserve(96);
+        addToBinary(data);
+        return data;
+    }
+
+    void addToBinary(std::string &data) const noexcept {
+        data += static_cast<char>(binaryVersion);
+        _board.addToBinary(data);
+        _actionPools.addToBinary(data);
+        _orbPositions.addToBinary(data);
+        _resourcePool.addToBinary(data);
+    }
+
+    [[nodiscard]] static auto fromBinary(const std::string_view &data) -> GameState {
+        BinaryReader reader{data};
+        auto result = fromBinary(reader);
+        if (not reader.atEnd()) {
+            throw Error("GameState: Unexpected data after the binary state.");
+        }
+        return result;
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> GameState {
+        if (reader.readByte() != binaryVersion) {
+            throw Error("GameState: Unsupported version of the binary state.");
+        }
+        auto board = Board::fromBinary(reader);
+        auto actionPools = ActionPools::fromBinary(reader);
+        auto orbPositions = OrbPositions::fromBinary(reader);
+        auto resourcePool = ResourcePool::fromBinary(reader);
+        return GameState{board, actionPools, orbPositions, resourcePool};
+    }
+
 public: // display
     [[nodiscard]] auto toString() const noexcept -> std::string {
         auto poolLines = actionPoolsToLines();
@@ -337,11 +548,23 @@ private:
 
 
 static_assert(Serializable<GameState>);
+static_assert(BinarySerializable<GameState>);
 
 
 template<>
 struct std::hash<GameState> {
     auto operator()(const GameState &gameState) const noexcept -> std::size_t {
-        return utility::hashFromValues(gameState._board, gameState._actionPools, gameState._orbPositions, gameState._resourcePool);
+        return gameState.zobristKey();
     }
 };
+
+
+template<typename Fn>
+auto OrbMoves::forEachForState(const GameState &state, Fn &&fn, const Player perspective) noexcept -> bool {
+    return OrbMoveCache::forEachMove(state.board(), state.orbPositions(), perspective, std::forward<Fn>(fn));
+}
+
+
+// The action generator needs the complete game state, and defines `ActionSequences::forEachForState()`, used
+// by `forEachMove()`.
+#include "ActionGenerator.hpp"
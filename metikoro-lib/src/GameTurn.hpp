@@ -12,7 +12,29 @@
 struct GameTurn {
     std::size_t turn = 0; ///< The turn number. 0 = initial turn.
     Player activePlayer; ///< The active player of this turn.
-    GameState state; ///< The state where this move is executed on, top-left corner = active player.
-    GameMove gameMove; ///< The move this player did, or no move to mark the end of the game.
+    GameState state; ///< The state where this move is executed on, in its original position.
+    GameMove gameMove; ///< The move this player did in the original position, or no move to mark the end of the game.
+
+    /// Get the state from the view of the active player, where the top-left corner = active player.
+    ///
+    [[nodiscard]] auto playerState() const noexcept -> GameState {
+        return state.rotatedToPlayer(activePlayer);
+    }
+
+    /// Get the state in its canonical form.
+    ///
+    /// @see GameState::canonicalRotation()
+    ///
+    [[nodiscard]] auto canonicalState() const noexcept -> GameState {
+        return state.rotated(state.canonicalRotation());
+    }
+
+    /// Get the rotation from the view of the active player into the canonical form.
+    ///
+    /// Use this rotation to permute ratings for the player view (index 0 = active player) to the canonical form.
+    ///
+    [[nodiscard]] auto canonicalRotation() const noexcept -> Rotation {
+        return state.canonicalRotation() - GameState::rotationToPlayer(activePlayer);
+    }
 };
 
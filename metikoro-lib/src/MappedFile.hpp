@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Error.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/// A file that is mapped read-only into memory.
+///
+/// The pages are only read from the disk when they are accessed, so opening a large file is
+/// independent of its size.
+///
+class MappedFile {
+public:
+    /// Map a file into memory.
+    ///
+    /// @throws Error If the file can not be opened or mapped.
+    ///
+    explicit MappedFile(const std::filesystem::path &path) {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw Error{std::format("Could not open file: {}: {}", path.string(), std::strerror(errno))};
+        }
+        struct stat fileStat{};
+        if (::fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            throw Error{std::format("Could not read the size of file: {}: {}", path.string(), std::strerror(errno))};
+        }
+        _size = static_cast<std::size_t>(fileStat.st_size);
+        if (_size > 0) {
+            _data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd); // The mapping keeps its own reference to the file.
+        if (_data == MAP_FAILED) {
+            _data = nullptr;
+            throw Error{std::format("Could not map file: {}: {}", path.string(), std::strerror(errno))};
+        }
+    }
+
+    ~MappedFile() {
+        if (_data != nullptr) {
+            ::munmap(_data, _size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+public:
+    [[nodiscard]] auto data() const noexcept -> const std::byte* { return static_cast<const std::byte*>(_data); }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _size; }
+
+private:
+    void *_data{nullptr}; ///< The start of the mapping, or null for an empty file.
+    std::size_t _size{0}; ///< The size of the file.
+};
+
@@ -0,0 +1,52 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Action.hpp"
+#include "ActionPool.hpp"
+#include "Board.hpp"
+#include "Field.hpp"
+#include "OrbPositions.hpp"
+#include "Player.hpp"
+#include "Position.hpp"
+#include "PositionMask.hpp"
+#include "ResourcePool.hpp"
+#include "Setup.hpp"
+
+#include <array>
+#include <cstdint>
+
+
+/// The information required to revert a move, or a sequence of actions, on a game state.
+///
+/// Instead of a copy of the whole state, this only stores the parts that can change: the fields touched
+/// by the actions, the action pool of the player, the resource pool and the orbs. If the move started a
+/// new turn, also the ko-locked fields before the ko locks were decreased.
+///
+/// @see GameState::executeMove(), GameState::executeActions(), GameState::undo()
+///
+struct MoveUndo {
+    using ChangedField = std::pair<Position, Field>;
+    using ChangedFields = std::array<ChangedField, Action::maximumPerMove>;
+
+    ChangedFields changedFields{}; ///< The original fields changed by the actions.
+    uint8_t changedFieldCount{0}; ///< The number of valid entries in `changedFields`.
+    bool hasNextTurn{false}; ///< If the move started a new turn.
+    Board::Plane koLocked{}; ///< The ko-locked fields before the new turn started.
+    Player player{}; ///< The player who made the move.
+    ActionPool actionPool{}; ///< The action pool of the player before the move.
+    ResourcePool resourcePool{}; ///< The resource pool before the move.
+    OrbPositions orbPositions{}; ///< The orb positions before the move.
+
+    /// The positions of all fields changed by the actions.
+    ///
+    [[nodiscard]] auto changedPositions() const noexcept -> PositionMask<setup::boardSize> {
+        PositionMask<setup::boardSize> result;
+        for (uint8_t i = 0; i < changedFieldCount; ++i) {
+            result.set(changedFields[i].first);
+        }
+        return result;
+    }
+};
+
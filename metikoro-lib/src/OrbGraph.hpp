@@ -0,0 +1,173 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Anchor.hpp"
+#include "Board.hpp"
+#include "OrbTravelPoint.hpp"
+#include "Player.hpp"
+#include "PositionMask.hpp"
+#include "Setup.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+
+/// The orb travel paths of a board, compiled into a graph.
+///
+/// Every node is a point where an orb enters a field: the position and the anchor it enters from. The edges
+/// lead to the points where the orb can enter the next field. The graph is compiled once for a board and
+/// reused for all orbs. A search over it visits every node only once, so the cost does not grow with the
+/// number of paths, like it does when all paths are followed.
+///
+class OrbGraph {
+public:
+    using Mask = PositionMask<setup::boardSize>;
+
+    /// The number of nodes in the graph.
+    ///
+    static constexpr std::size_t nodeCount = static_cast<std::size_t>(setup::boardSize) * setup::boardSize * Anchor::count;
+
+public:
+    /// Compile the graph for a board.
+    ///
+    /// @param board The board.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    ///
+    OrbGraph(const Board &board, const Player perspective) noexcept : _perspective{perspective} {
+        for (Length y = 0; y < setup::boardSize; ++y) {
+            for (Length x = 0; x < setup::boardSize; ++x) {
+                compileField(board, Position{x, y});
+            }
+        }
+    }
+
+public:
+    /// Compile the nodes of one field again, after it was changed on the board.
+    ///
+    /// The nodes of a field only depend on the field itself, so all other nodes stay valid.
+    ///
+    /// @param board The board with the changed field.
+    /// @param position The position of the changed field.
+    ///
+    void updateField(const Board &board, const Position position) noexcept {
+        for (const auto entry : Anchor::all()) {
+            _nodes[nodeIndex(position, entry)] = {};
+        }
+        compileField(board, position);
+    }
+
+    /// Get all positions where an orb can stop, starting at the given position.
+    ///
+    /// @param startPosition The position of the orb.
+    /// @return A mask with all reachable stop positions.
+    ///
+    [[nodiscard]] auto stopsFrom(const Position startPosition) const noexcept -> Mask {
+        Mask touchedPositions;
+        return stopsFrom(startPosition, touchedPositions);
+    }
+
+    /// Get all positions where an orb can stop, and all positions the search touched.
+    ///
+    /// The result only changes if one of the touched fields is changed.
+    ///
+    /// @param startPosition The position of the orb.
+    /// @param touchedPositions Receives the positions of all fields the orb can enter.
+    /// @return A mask with all reachable stop positions.
+    ///
+    [[nodiscard]] auto stopsFrom(const Position startPosition, Mask &touchedPositions) const noexcept -> Mask {
+        Mask result;
+        std::bitset<nodeCount> visited;
+        std::array<uint16_t, nodeCount> stack; // every node is pushed at most once.
+        std::size_t stackSize = 0;
+        const auto startIndex = nodeIndex(startPosition, Anchor::Stop);
+        visited.set(startIndex);
+        stack[stackSize++] = static_cast<uint16_t>(startIndex);
+        while (stackSize > 0) {
+            const auto index = stack[--stackSize];
+            const auto &node = _nodes[index];
+            touchedPositions.setIndex(index / Anchor::count);
+            if (node.isStop) {
+                result.setIndex(index / Anchor::count);
+            }
+            for (uint8_t i = 0; i < node.nextCount; ++i) {
+                const auto nextIndex = node.next[i];
+                if (not visited.test(nextIndex)) {
+                    visited.set(nextIndex);
+                    stack[stackSize++] = nextIndex;
+                }
+            }
+        }
+        return result;
+    }
+
+    /// Test if an orb can travel between two neighbour positions on the board.
+    ///
+    /// @param startPosition The position where the orb is.
+    /// @param stopPosition The position where the orb travels to.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    ///
+    [[nodiscard]] static auto canTravel(
+        const Position startPosition,
+        const Position stopPosition,
+        const Player perspective = Player{0}) noexcept -> bool {
+
+        const auto startIsHouse = Board::isHouse(startPosition);
+        const auto stopIsHouse = Board::isHouse(stopPosition);
+        if (stopIsHouse and Board::playerForField(stopPosition) != perspective) {
+            return false; // Can't move an orb in the house of another player.
+        }
+        if (startIsHouse and not stopIsHouse) {
+            return false;
+        }
+        if (not Board::isSource(startPosition) and Board::isSource(stopPosition)) {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    /// One node in the graph.
+    ///
+    struct Node {
+        std::array<uint16_t, Anchor::sideCount> next{}; ///< The indexes of the next nodes.
+        uint8_t nextCount{0}; ///< The number of next nodes.
+        bool isStop{false}; ///< If the orb can stop on this field, coming from this anchor.
+    };
+
+    void compileField(const Board &board, const Position position) noexcept {
+        const auto field = board.field(position);
+        if (field.empty()) {
+            return;
+        }
+        for (const auto entry : Anchor::all()) {
+            auto &node = _nodes[nodeIndex(position, entry)];
+            const auto exits = field.connectionsFrom(entry);
+            for (const auto exit : Anchor::all()) {
+                if (not exits.contains(exit)) {
+                    continue;
+                }
+                if (exit == Anchor::Stop) {
+                    node.isStop = true;
+                    continue;
+                }
+                const auto next = exit.nextPoint(position);
+                if (Mask::contains(next.position()) and canTravel(position, next.position(), _perspective)) {
+                    node.next[node.nextCount] = static_cast<uint16_t>(nodeIndex(next.position(), next.anchor()));
+                    node.nextCount += 1;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] static auto nodeIndex(const Position position, const Anchor anchor) noexcept -> std::size_t {
+        return Mask::index(position) * Anchor::count + anchor.value();
+    }
+
+private:
+    Player _perspective; ///< The active player.
+    std::array<Node, nodeCount> _nodes{}; ///< All nodes, indexed by position and entry anchor.
+};
+
@@ -4,6 +4,8 @@
 
 
 #include "Position.hpp"
+#include "Rotation.hpp"
+#include "Setup.hpp"
 
 #include <vector>
 
@@ -29,6 +31,9 @@ public:
     [[nodiscard]] auto start() const noexcept -> Position { return _start; }
     [[nodiscard]] auto stop() const noexcept -> Position { return _stop; }
     [[nodiscard]] auto isNoMove() const noexcept -> bool { return _start == _stop; }
+    [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> OrbMove {
+        return {_start.rotated(rotation, setup::boardSize), _stop.rotated(rotation, setup::boardSize)};
+    }
     [[nodiscard]] auto toString() const noexcept -> std::string {
         if (isNoMove()) {
             return "OrbMove(no move)";
@@ -0,0 +1,181 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Board.hpp"
+#include "OrbGraph.hpp"
+#include "OrbMoves.hpp"
+#include "OrbPositions.hpp"
+#include "Player.hpp"
+#include "Setup.hpp"
+#include "Utilities.hpp"
+
+#include <array>
+
+
+/// The orb moves of a base state, reused for states where only a few fields were changed.
+///
+/// Actions change at most two fields and never move an orb. For every orb, the cache keeps the stops and
+/// the fields its search touched in the base state. After fields were changed, only the orbs that touched
+/// one of them are searched again, and only the nodes of the changed fields are compiled again.
+///
+class OrbMoveCache {
+public:
+    using Mask = OrbGraph::Mask;
+
+public:
+    /// Create the cache for a base state.
+    ///
+    /// @param board The board of the base state. It is stored as reference, make sure it exists while the
+    ///     cache is used!
+    /// @param orbPositions The orbs of the base state.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    ///
+    OrbMoveCache(const Board &board, const OrbPositions &orbPositions, const Player perspective) noexcept
+        : _baseBoard{board}, _orbMask{orbPositions.mask()}, _graph{board, perspective} {
+
+        forEachMovableOrb(orbPositions, perspective, [this](const OrbPosition &orbPosition) {
+            auto &orb = _orbs[_orbCount];
+            orb.position = orbPosition.position;
+            orb.koPosition = orbPosition.koPosition;
+            orb.stops = _graph.stopsFrom(orb.position, orb.touchedPositions);
+            _orbCount += 1;
+        });
+        generateMoves(
+            [](const Orb &orb) { return orb.stops; },
+            [this](const OrbMove &move) { _baseMoves.add(move); });
+    }
+
+public:
+    /// Call a function for each orb move of a state, without creating a cache or a list.
+    ///
+    /// The moves are visited in the order of `orbMoves()`. The stops of an orb are only searched when its
+    /// moves are visited, so stopping the iteration early also skips the search of the remaining orbs.
+    ///
+    /// @param board The board of the state.
+    /// @param orbPositions The orbs of the state.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @param fn The visitor, called with a `const OrbMove&`. If it returns `bool`, `false` stops the iteration.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    static auto forEachMove(
+        const Board &board,
+        const OrbPositions &orbPositions,
+        const Player perspective,
+        Fn &&fn) noexcept -> bool {
+
+        if (not utility::callVisitor(fn, OrbMove{})) {
+            return false; // There is always the option to not move the orb.
+        }
+        const OrbGraph graph{board, perspective};
+        const auto orbMask = orbPositions.mask();
+        return forEachMovableOrb(orbPositions, perspective, [&](const OrbPosition &orbPosition) {
+            return forEachStop(orbPosition.position, orbPosition.koPosition,
+                graph.stopsFrom(orbPosition.position), orbMask, fn);
+        });
+    }
+
+public:
+    /// Get the orb moves of the base state.
+    ///
+    [[nodiscard]] auto orbMoves() const noexcept -> const OrbMoves& {
+        return _baseMoves;
+    }
+
+    /// Get the orb moves for a board, where the given fields differ from the base state.
+    ///
+    /// @param board The changed board. The orbs must be the same as in the base state.
+    /// @param changedPositions The positions of all fields that differ from the base state.
+    /// @return The orb moves. The reference is valid until the next call of this method.
+    ///
+    [[nodiscard]] auto orbMoves(const Board &board, const Mask &changedPositions) noexcept -> const OrbMoves& {
+        if (changedPositions.empty()) {
+            return _baseMoves;
+        }
+        changedPositions.forEach([&](const Position position) { _graph.updateField(board, position); });
+        _changedMoves.clear();
+        generateMoves(
+            [&](const Orb &orb) {
+                if ((orb.touchedPositions & changedPositions).empty()) {
+                    return orb.stops;
+                }
+                return _graph.stopsFrom(orb.position);
+            },
+            [this](const OrbMove &move) { _changedMoves.add(move); });
+        changedPositions.forEach([&](const Position position) { _graph.updateField(_baseBoard, position); });
+        return _changedMoves;
+    }
+
+private:
+    /// The cached search of one orb.
+    ///
+    struct Orb {
+        Position position{Position::invalid()}; ///< The position of the orb.
+        Position koPosition{Position::invalid()}; ///< The position the orb can't move back to.
+        Mask stops; ///< The stops in the base state.
+        Mask touchedPositions; ///< The fields touched by the search in the base state.
+    };
+
+    /// Call a function for each orb of the active player, that is not in the house of another player.
+    ///
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    static auto forEachMovableOrb(const OrbPositions &orbPositions, const Player perspective, Fn &&fn) noexcept -> bool {
+        for (const auto &orbPosition : orbPositions.positions()) {
+            if (orbPosition.position.isInvalid()) {
+                break; // We reached the end of the in-game orb positions.
+            }
+            if (Board::isHouse(orbPosition.position) && Board::playerForField(orbPosition.position) != perspective) {
+                continue; // Can't move an orb in the house of another player.
+            }
+            if (not utility::callVisitor(fn, orbPosition)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Call a function for each valid move of an orb to one of its stops.
+    ///
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    static auto forEachStop(
+        const Position position,
+        const Position koPosition,
+        Mask stops,
+        const Mask &orbMask,
+        Fn &fn) noexcept -> bool {
+
+        stops &= ~orbMask; // Can't move an orb into another orb.
+        stops.reset(koPosition); // Can't move an orb back to its previous position (ko lock).
+        return stops.forEach([&](const Position stop) { return utility::callVisitor(fn, OrbMove{position, stop}); });
+    }
+
+    /// Call a function for the no-move option and the moves of all orbs.
+    ///
+    /// @param stopsFn The function that returns the stops for an orb.
+    /// @param fn The function to call for each move.
+    ///
+    template<typename StopsFn, typename Fn>
+    void generateMoves(StopsFn &&stopsFn, Fn &&fn) const noexcept {
+        fn(OrbMove{}); // There is always the option to not move the orb.
+        for (std::size_t i = 0; i < _orbCount; ++i) {
+            const auto &orb = _orbs[i];
+            forEachStop(orb.position, orb.koPosition, stopsFn(orb), _orbMask, fn);
+        }
+    }
+
+private:
+    const Board &_baseBoard; ///< The board of the base state.
+    Mask _orbMask; ///< The positions of all orbs.
+    OrbGraph _graph; ///< The graph of the base state, temporarily updated for changed fields.
+    std::array<Orb, setup::orbCount> _orbs{}; ///< The orbs that can be moved.
+    std::size_t _orbCount{0}; ///< The number of valid entries in `_orbs`.
+    OrbMoves _baseMoves; ///< The orb moves of the base state.
+    OrbMoves _changedMoves; ///< The orb moves for the last changed board.
+};
+
@@ -4,6 +4,8 @@
 
 
 #include "GameState.hpp"
+#include "OrbGraph.hpp"
+#include "OrbMoveCache.hpp"
 #include "OrbTravelNode.hpp"
 
 #include <iostream>
@@ -38,7 +40,7 @@ if constexpr (debugMessages) { \
 ///
 template<typename DebugInterface = OrbMoveGeneratorNoDebug>
 class OrbMoveGenerator {
-    static constexpr bool debugMessages = not std::is_same_v<OrbMoveGeneratorDebugInterface, OrbMoveGeneratorNoDebug>;
+    static constexpr bool debugMessages = not std::is_same_v<DebugInterface, OrbMoveGeneratorNoDebug>;
     static constexpr auto minimumStackSize = 64;
     static constexpr auto maximumStackSize = 1024;
 
@@ -62,68 +64,43 @@ public:
     /// Create a new instance of the orb move generator.
     ///
     /// @param state The state to use. It is stored as reference, make sure it exists while the generator is running!
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
     ///
-    explicit OrbMoveGenerator(const GameState &state) : _state{state} {
-        _stack.reserve(minimumStackSize);
+    explicit OrbMoveGenerator(const GameState &state, const Player perspective = Player{0})
+        : _state{state}, _perspective{perspective} {
     }
 
     /// Create a new instance for debugging.
     ///
-    OrbMoveGenerator(const GameState &state, DebugInterface *debugInterface) : _state{state}, _debugInterface{debugInterface} {
+    OrbMoveGenerator(const GameState &state, DebugInterface *debugInterface, const Player perspective = Player{0})
+        : _state{state}, _perspective{perspective}, _debugInterface{debugInterface} {
         if (debugInterface == nullptr) {
             throw Error("OrbMoveGenerator(): debugInterface must not be null.");
         }
-        _stack.reserve(minimumStackSize);
     }
 
     /// Get all valid orb movements for the given state.
     ///
+    /// @see OrbMoveCache
+    ///
     [[nodiscard]] auto allMoves() noexcept -> OrbMoves {
         ORB_MOVE_GENERATOR_DEBUG("allMoves()");
-        OrbMoves result;
-        result.add(OrbMove{}); // There is always the option to not move the orb.
-        for (const auto orbPosition : _state.orbPositions().positions()) {
-            const auto startPosition = orbPosition.position;
-            if (startPosition.isInvalid()) {
-                break; // We reached the end of the in-game orb positions.
-            }
-            ORB_MOVE_GENERATOR_DEBUG(std::format("start position = {}", startPosition.toString()));
-            if (Board::isHouse(startPosition) && Board::playerForField(startPosition) != Player{0}) {
-                ORB_MOVE_GENERATOR_DEBUG("can't move orb in house of other player.");
-                continue; // Can't move an orb in the house of another player.
-            }
-            PositionList stopPositions;
-            followAllPaths(
-                startPosition,
-                [&](const PositionPair &pair, const OrbTravelNodeStack &) {
-                stopPositions.emplace_back(pair.second);
-            });
-            ORB_MOVE_GENERATOR_DEBUG(std::format("found {} valid stop positions.", stopPositions.size()));
-            for (const auto stopPosition : stopPositions) {
-                if (_state.orbPositions().isOrbAt(stopPosition)) {
-                    continue; // Can't move an orb into another orb.
-                }
-                if (_state.orbPositions().koPosition(startPosition) == stopPosition) {
-                    continue; // Can't move an orb back to its previous position (ko lock).
-                }
-                auto orbMove = OrbMove{startPosition, stopPosition};
-                if (not result.contains(orbMove)) { // filter duplicates
-                    result.add(orbMove);
-                }
-            }
-        }
+        auto result = OrbMoveCache{_state.board(), _state.orbPositions(), _perspective}.orbMoves();
         ORB_MOVE_GENERATOR_DEBUG(std::format("found {} possible orb moves (including no move).", result.size()));
         return result;
     }
 
     /// Follow the path from the given start position and report all stops.
     ///
+    /// Unlike `allMoves()`, this reports every path to a stop, which is useful for debugging and analysis.
+    ///
     /// @param startPosition The start position.
     /// @param addPathFn The function that shall be called when a stop is found.
     ///
     void followAllPaths(Position startPosition, const AddPathFn &addPathFn) noexcept {
         ORB_MOVE_GENERATOR_DEBUG(std::format("followAllPaths({}, fn)", startPosition.toString()));
         _stack.clear();
+        _stack.reserve(minimumStackSize); // only allocated, if paths are followed.
         pushNext(OrbTravelPoint{startPosition, Anchor::Stop});
         while (not _stack.empty()) {
             auto &node = _stack.back();
@@ -157,7 +134,7 @@ public:
         const auto next = node.nextPoint();
         ORB_MOVE_GENERATOR_DEBUG(std::format("next={}", next.toString()));
         if (not doesLoop(next)) {
-            if (canTravel(node.position(), next.position())) { // test if the position travel is legit
+            if (canTravel(node.position(), next.position(), _perspective)) { // test if the position travel is legit
                 if (pushNext(next)) {
                     return true;
                 }
@@ -218,23 +195,21 @@ public:
 
     /// Test if we can travel between two positions on the board.
     ///
-    static auto canTravel(const Position startPosition, const Position stopPosition) noexcept -> bool {
-        const auto startIsHouse = Board::isHouse(startPosition);
-        const auto stopIsHouse = Board::isHouse(stopPosition);
-        if (stopIsHouse and Board::playerForField(stopPosition) != Player{0}) {
-            return false; // Can't move an orb in the house of another player.
-        }
-        if (startIsHouse and not stopIsHouse) {
-            return false;
-        }
-        if (not Board::isSource(startPosition) and Board::isSource(stopPosition)) {
-            return false;
-        }
-        return true;
+    /// @param startPosition The position where the orb is.
+    /// @param stopPosition The position where the orb travels to.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    ///
+    static auto canTravel(
+        const Position startPosition,
+        const Position stopPosition,
+        const Player perspective = Player{0}) noexcept -> bool {
+
+        return OrbGraph::canTravel(startPosition, stopPosition, perspective);
     }
 
 private:
     const GameState &_state;
+    Player _perspective; ///< The active player.
     Stack _stack{};
     DebugInterface *_debugInterface{};
 };
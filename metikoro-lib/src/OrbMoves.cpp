@@ -6,7 +6,7 @@
 #include "OrbMoveGenerator.hpp"
 
 
-auto OrbMoves::allForState(const GameState &state) noexcept -> OrbMoves {
-    OrbMoveGenerator generator{state};
+auto OrbMoves::allForState(const GameState &state, const Player perspective) noexcept -> OrbMoves {
+    OrbMoveGenerator generator{state, perspective};
     return generator.allMoves();
 }
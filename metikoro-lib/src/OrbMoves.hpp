@@ -3,9 +3,13 @@
 #pragma once
 
 
+#include "GameArena.hpp"
 #include "OrbMove.hpp"
+#include "Player.hpp"
 
+#include <memory_resource>
 #include <ranges>
+#include <vector>
 #include <__algorithm/ranges_any_of.h>
 
 
@@ -14,13 +18,23 @@ class GameState;
 
 /// A list of orb movements.
 ///
+/// The list is allocated from the active game arena of the calling thread, if there is one.
+///
+/// A list from an arena must not outlive the game. A copy is allocated from the arena that is active when
+/// it is created, but a moved list keeps the arena of its source.
+///
 class OrbMoves {
 public:
-    using Moves = std::vector<OrbMove>;
+    using Moves = std::pmr::vector<OrbMove>;
 
 public:
-    OrbMoves() = default;
-    explicit OrbMoves(const std::vector<OrbMove> &moves) noexcept : _moves{moves} {}
+    OrbMoves() noexcept : _moves{GameArena::currentResource()} {}
+    explicit OrbMoves(const std::vector<OrbMove> &moves)
+        : _moves{moves.begin(), moves.end(), GameArena::currentResource()} {}
+    OrbMoves(const OrbMoves &other) : _moves{other._moves, GameArena::currentResource()} {}
+    OrbMoves(OrbMoves &&other) noexcept = default;
+    auto operator=(const OrbMoves &other) -> OrbMoves& = default;
+    auto operator=(OrbMoves &&other) noexcept -> OrbMoves& = default;
 
 public:
     [[nodiscard]] auto operator==(const OrbMoves &other) const noexcept -> bool = default;
@@ -38,15 +52,37 @@ public: // accessors
     }
 
 public: // modifiers
-    void add(const OrbMove &move) noexcept { _moves.emplace_back(move); }
-    void add(OrbMove &&move) noexcept { _moves.emplace_back(move); }
-    void add(const OrbMoves &moves) noexcept { _moves.insert(_moves.end(), moves.begin(), moves.end()); }
+    void add(const OrbMove &move) { _moves.emplace_back(move); }
+    void add(OrbMove &&move) { _moves.emplace_back(move); }
+    void add(const OrbMoves &moves) { _moves.insert(_moves.end(), moves.begin(), moves.end()); }
     void clear() noexcept { _moves.clear(); }
 
 public: // methods
     /// Generate all possible orb movements for the current player in the given state.
     ///
-    [[nodiscard]] static auto allForState(const GameState &state) noexcept -> OrbMoves;
+    /// @param state The state.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    ///
+    [[nodiscard]] static auto allForState(
+        const GameState &state,
+        Player perspective = Player{0}) noexcept -> OrbMoves;
+
+    /// Call a function for each possible orb movement for the current player in the given state.
+    ///
+    /// No list is created, and the stops of each orb are only searched when its moves are visited. This
+    /// method is defined in `GameState.hpp`.
+    /// @see OrbMoveCache::forEachMove()
+    ///
+    /// @param state The state.
+    /// @param fn The visitor, called with a `const OrbMove&`. If it returns `bool`, `false` stops the iteration.
+    /// @param perspective The active player. Player 0, if the state is rotated for the active player.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    static auto forEachForState(
+        const GameState &state,
+        Fn &&fn,
+        Player perspective = Player{0}) noexcept -> bool;
 
 private:
     Moves _moves;
@@ -5,15 +5,16 @@
 
 #include "OrbPosition.hpp"
 #include "Position.hpp"
+#include "PositionMask.hpp"
 #include "Rotation.hpp"
 #include "Setup.hpp"
+#include "Zobrist.hpp"
 
 
 class OrbPositions {
-    friend struct std::hash<OrbPositions>;
-
 public:
     using Positions = std::array<OrbPosition, setup::orbCount>;
+    using Mask = PositionMask<setup::boardSize>;
 
 public:
     OrbPositions() = default;
@@ -24,6 +25,29 @@ public:
 public:
     [[nodiscard]] auto positions() const noexcept -> const Positions& { return _positions; }
 
+    /// The positions of all orbs in the game, as bit mask over the board.
+    ///
+    [[nodiscard]] auto mask() const noexcept -> const Mask& { return _mask; }
+
+    /// The Zobrist key of all orbs.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key { return _key; }
+
+    /// The Zobrist key of all orbs in a rotated state, without rotating the orbs.
+    ///
+    [[nodiscard]] auto zobristKey(const Rotation rotation) const noexcept -> zobrist::Key {
+        if (rotation.wrapToClockwise().isNone()) {
+            return _key;
+        }
+        zobrist::Key result{};
+        for (auto op : _positions) {
+            op.position = op.position.rotated(rotation, setup::boardSize);
+            op.koPosition = op.koPosition.rotated(rotation, setup::boardSize);
+            result ^= zobrist::orbKey(op);
+        }
+        return result;
+    }
+
     [[nodiscard]] auto koPosition(Position orbPosition) const noexcept -> Position {
         const auto it = std::ranges::find_if(
             _positions,
@@ -35,9 +59,7 @@ public:
     }
 
     [[nodiscard]] auto inGameCount() const noexcept -> uint8_t {
-        auto it = std::ranges::find_if(_positions, isPosInvalid);
-        if (it == _positions.end()) { return _positions.size(); }
-        return static_cast<uint8_t>(std::distance(_positions.begin(), it));
+        return static_cast<uint8_t>(_mask.count());
     }
 
     [[nodiscard]] auto hasSpare() const noexcept -> bool {
@@ -45,9 +67,10 @@ public:
     }
 
     [[nodiscard]] auto isOrbAt(Position position) const noexcept -> bool {
-        return std::ranges::find_if(_positions, [position](const OrbPosition &op) {
-            return op.position == position;
-        }) != _positions.end();
+        if (position.isInvalid()) {
+            return hasSpare(); // spare orbs have an invalid position.
+        }
+        return _mask.test(position);
     }
 
     [[nodiscard]] auto rotated(const Rotation rotation) const noexcept -> OrbPositions {
@@ -57,6 +80,7 @@ public:
             op.koPosition = op.koPosition.rotated(rotation, setup::boardSize);
         }
         result.sort();
+        result.updateDerived();
         return result;
     }
 
@@ -74,20 +98,26 @@ public:
             throw Error("OrbPositions::moveOrb - no orb found at old position.");
         }
         if (it != _positions.end()) {
+            _key ^= zobrist::orbKey(*it);
             it->koPosition = it->position;
             it->koLock = 3;
             it->position = newPosition;
+            _key ^= zobrist::orbKey(*it);
         }
+        _mask.reset(oldPosition);
+        _mask.set(newPosition);
         sort();
     }
 
     void nextTurn() noexcept {
         for (auto &op : _positions) {
             if (op.koLock > 0) {
+                _key ^= zobrist::orbKey(op);
                 op.koLock -= 1;
                 if (op.koLock == 0) {
                     op.koPosition = Position::invalid();
                 }
+                _key ^= zobrist::orbKey(op);
             }
         }
     }
@@ -111,35 +141,116 @@ public: // serialization
         for (std::size_t i = 0; i < result._positions.size(); ++i) {
             result._positions.at(i) = OrbPosition::fromData(data.substr(i * OrbPosition::dataSize(), OrbPosition::dataSize()));
         }
+        result.updateDerived();
+        return result;
+    }
+
+public: // binary serialization
+    /// Add the orbs in their binary form.
+    ///
+    /// The number of orbs in the game is followed by one byte per orb position. Next is the number of
+    /// ko-locked orbs, with two bytes each: the orb index with the ko lock in the lower two bits,
+    /// and the ko position. Positions are stored as `y * boardSize + x`, invalid positions as `0xff`.
+    ///
+    void addToBinary(std::string &data) const noexcept {
+        const auto count = inGameCount();
+        data += static_cast<char>(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            data += static_cast<char>(positionToBinary(_positions[i].position));
+        }
+        const auto koCount = std::ranges::count_if(_positions, [](const OrbPosition &op) { return op.koLock != 0; });
+        data += static_cast<char>(koCount);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (_positions[i].koLock != 0) {
+                data += static_cast<char>((i << 2U) | _positions[i].koLock);
+                data += static_cast<char>(positionToBinary(_positions[i].koPosition));
+            }
+        }
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> OrbPositions {
+        OrbPositions result;
+        const auto count = reader.readByte();
+        if (count > setup::orbCount) {
+            throw Error("OrbPositions: Invalid orb count in binary data.");
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            result._positions[i].position = positionFromBinary(reader.readByte());
+            if (result._positions[i].position.isInvalid()) {
+                throw Error("OrbPositions: Invalid orb position in binary data.");
+            }
+        }
+        const auto koCount = reader.readByte();
+        for (std::size_t i = 0; i < koCount; ++i) {
+            const auto value = reader.readByte();
+            const auto index = static_cast<std::size_t>(value >> 2U);
+            if (index >= count) {
+                throw Error("OrbPositions: Invalid ko lock in binary data.");
+            }
+            result._positions[index].koLock = value & 0x03U;
+            result._positions[index].koPosition = positionFromBinary(reader.readByte());
+        }
+        result.sort();
+        result.updateDerived();
         return result;
     }
 
 private:
+    constexpr static uint8_t invalidBinaryPosition = 0xffU;
+
+    [[nodiscard]] static auto positionToBinary(const Position position) noexcept -> uint8_t {
+        if (position.isInvalid()) {
+            return invalidBinaryPosition;
+        }
+        return static_cast<uint8_t>(position.y() * setup::boardSize + position.x());
+    }
+
+    [[nodiscard]] static auto positionFromBinary(const uint8_t value) -> Position {
+        if (value == invalidBinaryPosition) {
+            return Position::invalid();
+        }
+        if (value >= setup::boardSize * setup::boardSize) {
+            throw Error("OrbPositions: Invalid position in binary data.");
+        }
+        return Position{static_cast<Length>(value % setup::boardSize), static_cast<Length>(value / setup::boardSize)};
+    }
+
     void sort() noexcept {
-        std::ranges::stable_sort(
-            _positions, [](const OrbPosition &a, const OrbPosition &b) {
-                return a.position < b.position;
+        // A stable insertion sort, that does not need a temporary buffer like `std::ranges::stable_sort`.
+        for (std::size_t i = 1; i < _positions.size(); ++i) {
+            const auto orbPosition = _positions[i];
+            auto j = i;
+            for (; j > 0 and orbPosition.position < _positions[j - 1].position; --j) {
+                _positions[j] = _positions[j - 1];
             }
-        );
+            _positions[j] = orbPosition;
+        }
     }
 
-private:
-    static auto isPosInvalid(const OrbPosition &op) noexcept -> bool {
-        return op.position.isInvalid();
+    void updateDerived() noexcept {
+        _mask.clear();
+        _key = 0;
+        for (const auto &op : _positions) {
+            _mask.set(op.position); // ignores invalid positions.
+            _key ^= zobrist::orbKey(op);
+        }
     }
 
 private:
     Positions _positions;
+    Mask _mask{}; ///< Derived from `_positions`.
+    zobrist::Key _key{}; ///< Derived from `_positions`.
 };
 
 
 static_assert(Serializable<OrbPositions>);
+static_assert(BinarySerializable<OrbPositions>);
 
 
 template<>
 struct std::hash<OrbPositions> {
     auto operator()(const OrbPositions &orbPositions) const noexcept -> std::size_t {
-        return utility::hashFromArray(orbPositions._positions);
+        return orbPositions.zobristKey();
     }
 };
 
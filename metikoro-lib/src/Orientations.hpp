@@ -16,16 +16,16 @@ public:
     constexpr Orientations(Orientation::Value first, Ts... values) noexcept
         : _orientations(((Orientation(first).flag()) | ... | (Orientation(values).flag()))) {}
 
-    [[nodiscard]] auto operator==(const Orientations &other) const noexcept -> bool = default;
+    [[nodiscard]] constexpr auto operator==(const Orientations &other) const noexcept -> bool = default;
 
-    auto operator|(const Orientation &orientation) const noexcept -> Orientations {
+    constexpr auto operator|(const Orientation &orientation) const noexcept -> Orientations {
         return Orientations{static_cast<uint8_t>(_orientations | orientation.flag())};
     }
-    auto operator|(const Orientations &orientations) const noexcept -> Orientations {
+    constexpr auto operator|(const Orientations &orientations) const noexcept -> Orientations {
         return Orientations{static_cast<uint8_t>(_orientations | orientations._orientations)};
     }
-    auto operator|=(const Orientation &orientation) noexcept -> Orientations& { _orientations |= orientation.flag(); return *this; }
-    auto operator|=(const Orientations &orientations) noexcept -> Orientations& { _orientations |= orientations._orientations; return *this; }
+    constexpr auto operator|=(const Orientation &orientation) noexcept -> Orientations& { _orientations |= orientation.flag(); return *this; }
+    constexpr auto operator|=(const Orientations &orientations) noexcept -> Orientations& { _orientations |= orientations._orientations; return *this; }
 
     [[nodiscard]] constexpr auto empty() const noexcept -> bool { return _orientations == 0; }
     [[nodiscard]] constexpr auto contains(Orientation orientation) const noexcept -> bool { return (_orientations & orientation.flag()) != 0; }
@@ -0,0 +1,163 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "ActionSequences.hpp"
+#include "Error.hpp"
+#include "GameState.hpp"
+
+#include <cstdint>
+#include <format>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// The counted nodes of a perft run.
+///
+/// Actions and orb moves are counted for every state at the last level before the given depth, moves are
+/// counted at the given depth. At depth 1, these are the sizes of `allActions()`, `allOrbMoves()` and
+/// `allMoves()` of the start state.
+///
+struct PerftCounts {
+    uint64_t actions{0}; ///< The number of action sequences.
+    uint64_t orbMoves{0}; ///< The number of orb moves.
+    uint64_t moves{0}; ///< The number of moves, the leaf nodes.
+
+    [[nodiscard]] auto operator==(const PerftCounts &other) const noexcept -> bool = default;
+
+    auto operator+=(const PerftCounts &other) noexcept -> PerftCounts& {
+        actions += other.actions;
+        orbMoves += other.orbMoves;
+        moves += other.moves;
+        return *this;
+    }
+
+    [[nodiscard]] auto total() const noexcept -> uint64_t {
+        return actions + orbMoves + moves;
+    }
+
+    [[nodiscard]] auto toString() const noexcept -> std::string {
+        return std::format("actions={} orbMoves={} moves={}", actions, orbMoves, moves);
+    }
+};
+
+
+/// Count the moves of a state up to a given depth.
+///
+/// The state must be in the view of the active player. After each move, the state is rotated into the view
+/// of the next player. Moves that end the game are leaf nodes and are not followed.
+///
+class Perft {
+public:
+    /// Create a new perft counter.
+    ///
+    /// @param depth The depth, at least 1.
+    /// @param mode Which action sequences are used for the moves.
+    ///
+    Perft(const std::size_t depth, const ActionSequences::Mode mode) noexcept : _depth{depth}, _mode{mode} {
+    }
+
+public:
+    [[nodiscard]] auto depth() const noexcept -> std::size_t { return _depth; }
+    [[nodiscard]] auto mode() const noexcept -> ActionSequences::Mode { return _mode; }
+
+    [[nodiscard]] static auto modeName(const ActionSequences::Mode mode) noexcept -> std::string_view {
+        return mode == ActionSequences::Mode::Canonical ? "canonical" : "all";
+    }
+
+    /// Get the mode for a name.
+    ///
+    /// @throws Error if the name is no valid mode.
+    ///
+    [[nodiscard]] static auto modeFromName(const std::string_view name) -> ActionSequences::Mode {
+        if (name == "all") {
+            return ActionSequences::Mode::All;
+        }
+        if (name == "canonical") {
+            return ActionSequences::Mode::Canonical;
+        }
+        throw Error{"Unknown perft mode: " + std::string{name}};
+    }
+
+    /// Count the nodes for a state.
+    ///
+    [[nodiscard]] auto count(const GameState &state) const -> PerftCounts {
+        return count(state, _depth);
+    }
+
+private:
+    [[nodiscard]] auto count(const GameState &state, const std::size_t depth) const -> PerftCounts {
+        PerftCounts result;
+        if (depth <= 1) {
+            result.actions = state.allActions(Player{0}, _mode).actions().size();
+            result.orbMoves = state.allOrbMoves().size();
+            state.forEachMove([&result](const GameMove&) { result.moves += 1; }, Player{0}, _mode);
+            return result;
+        }
+        auto workingState = state;
+        state.forEachMove([&](const GameMove &move) {
+            const auto undo = workingState.executeMove(move);
+            if (not workingState.hasWinner()) {
+                result += count(workingState.rotatedToPlayer(Player{1}), depth - 1);
+            }
+            workingState.undo(undo);
+        }, Player{0}, _mode);
+        return result;
+    }
+
+private:
+    std::size_t _depth; ///< The depth.
+    ActionSequences::Mode _mode; ///< Which action sequences are used.
+};
+
+
+/// One state of a perft reference file, with its expected counts.
+///
+/// Reference files contain one state per line, with the expected counts:
+/// `<state data> <depth> <all|canonical> <actions> <orb moves> <moves>`. Empty lines and lines starting
+/// with `#` are ignored. The files can be read as corpus by all other tools.
+/// @see StateCorpus
+///
+struct PerftReference {
+    GameState state; ///< The state, in the view of the active player.
+    std::size_t depth{1}; ///< The perft depth.
+    ActionSequences::Mode mode{ActionSequences::Mode::All}; ///< Which action sequences are counted.
+    PerftCounts expected; ///< The expected counts.
+
+    /// Create the line for a state of a reference file.
+    ///
+    [[nodiscard]] static auto toLine(const GameState &state, const Perft &perft, const PerftCounts &counts) -> std::string {
+        return std::format("{} {} {} {} {} {}", state.toData(), perft.depth(), Perft::modeName(perft.mode()),
+            counts.actions, counts.orbMoves, counts.moves);
+    }
+
+    /// Read all states from a reference file.
+    ///
+    /// @throws Error if a line is invalid.
+    ///
+    [[nodiscard]] static auto readAll(std::istream &input) -> std::vector<PerftReference> {
+        std::vector<PerftReference> result;
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() or line.starts_with('#')) {
+                continue;
+            }
+            std::istringstream fields{line};
+            std::string data;
+            std::string modeText;
+            PerftReference reference;
+            if (not (fields >> data >> reference.depth >> modeText
+                    >> reference.expected.actions >> reference.expected.orbMoves >> reference.expected.moves)) {
+                throw Error{"Invalid line in reference file: " + line};
+            }
+            reference.state = GameState::fromData(data);
+            reference.mode = Perft::modeFromName(modeText);
+            result.push_back(reference);
+        }
+        return result;
+    }
+};
@@ -57,13 +57,17 @@ public: // attributes
 
 public: // methods
     [[nodiscard]] auto isInvalid() const -> bool { return _data.x == maxLength || _data.y == maxLength; }
+    /// Rotate this position in a square grid.
+    ///
+    /// The rotation is clockwise as displayed, with the y-axis pointing down (north is at the top).
+    ///
     [[nodiscard]] auto rotated(const Rotation rotation, const Length size) const -> Position {
         if (isInvalid()) { return invalid(); }
-        switch (rotation) {
+        switch (rotation.wrapToClockwise()) {
         case Rotation::None: return *this;
-        case Rotation::Clockwise90: return {_data.y, static_cast<Length>(size - 1U - _data.x)};
-        case Rotation::Clockwise180: return {static_cast<Length>(size - 1U - _data.y), static_cast<Length>(size - 1U - _data.x)};
-        case Rotation::Clockwise270: return {static_cast<Length>(size - 1U - _data.x), _data.y};
+        case Rotation::Clockwise90: return {static_cast<Length>(size - 1U - _data.y), _data.x};
+        case Rotation::Clockwise180: return {static_cast<Length>(size - 1U - _data.x), static_cast<Length>(size - 1U - _data.y)};
+        case Rotation::Clockwise270: return {_data.y, static_cast<Length>(size - 1U - _data.x)};
         default: return *this;
         }
     }
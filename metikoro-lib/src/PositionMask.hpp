@@ -0,0 +1,266 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "BinaryReader.hpp"
+#include "FixedList.hpp"
+#include "Position.hpp"
+#include "Utilities.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+
+/// A bit mask with one bit for each position in a square grid.
+///
+/// The grid has a side length of `N` fields and starts at position `Offset`/`Offset`. Bit indexes follow the
+/// row order of the grid (`y` first, then `x`), so iterating a mask visits the positions in the same order
+/// as `Position::operator<`.
+///
+/// A 8×8 grid fits exactly into one 64-bit word, the full 10×10 board uses two words.
+///
+template<Length N, Length Offset = 0>
+class PositionMask {
+public:
+    static constexpr std::size_t sideLength = N;
+    static constexpr std::size_t bitCount = N * N;
+    static constexpr std::size_t wordCount = (bitCount + 63U) / 64U;
+    using Words = std::array<uint64_t, wordCount>;
+
+public:
+    constexpr PositionMask() = default;
+    constexpr explicit PositionMask(const Words &words) noexcept : _words{words} { clearUnusedBits(); }
+
+public: // operators
+    [[nodiscard]] constexpr auto operator==(const PositionMask &other) const noexcept -> bool = default;
+
+    [[nodiscard]] constexpr auto operator&(const PositionMask &other) const noexcept -> PositionMask {
+        auto result = *this;
+        result &= other;
+        return result;
+    }
+    [[nodiscard]] constexpr auto operator|(const PositionMask &other) const noexcept -> PositionMask {
+        auto result = *this;
+        result |= other;
+        return result;
+    }
+    [[nodiscard]] constexpr auto operator^(const PositionMask &other) const noexcept -> PositionMask {
+        auto result = *this;
+        result ^= other;
+        return result;
+    }
+    [[nodiscard]] constexpr auto operator~() const noexcept -> PositionMask {
+        auto result = *this;
+        for (auto &word : result._words) {
+            word = ~word;
+        }
+        result.clearUnusedBits();
+        return result;
+    }
+    constexpr auto operator&=(const PositionMask &other) noexcept -> PositionMask& {
+        for (std::size_t i = 0; i < wordCount; ++i) { _words[i] &= other._words[i]; }
+        return *this;
+    }
+    constexpr auto operator|=(const PositionMask &other) noexcept -> PositionMask& {
+        for (std::size_t i = 0; i < wordCount; ++i) { _words[i] |= other._words[i]; }
+        return *this;
+    }
+    constexpr auto operator^=(const PositionMask &other) noexcept -> PositionMask& {
+        for (std::size_t i = 0; i < wordCount; ++i) { _words[i] ^= other._words[i]; }
+        return *this;
+    }
+
+public: // attributes
+    [[nodiscard]] constexpr auto words() const noexcept -> const Words& { return _words; }
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        for (const auto word : _words) {
+            if (word != 0) { return false; }
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr auto count() const noexcept -> std::size_t {
+        std::size_t result = 0;
+        for (const auto word : _words) {
+            result += static_cast<std::size_t>(std::popcount(word));
+        }
+        return result;
+    }
+
+    /// Test if a position is part of this grid.
+    ///
+    [[nodiscard]] static auto contains(const Position position) noexcept -> bool {
+        return not position.isInvalid()
+            and position.x() >= Offset and position.x() < Offset + N
+            and position.y() >= Offset and position.y() < Offset + N;
+    }
+
+    /// Test the bit for a position.
+    ///
+    /// @return `false` for positions outside this grid.
+    ///
+    [[nodiscard]] auto test(const Position position) const noexcept -> bool {
+        if (not contains(position)) {
+            return false;
+        }
+        return testIndex(index(position));
+    }
+
+    [[nodiscard]] constexpr auto testIndex(const std::size_t index) const noexcept -> bool {
+        return (_words[index / 64U] & (uint64_t{1} << (index % 64U))) != 0;
+    }
+
+public: // modifiers
+    /// Set the bit for a position.
+    ///
+    /// Positions outside this grid are ignored.
+    ///
+    void set(const Position position) noexcept {
+        if (contains(position)) {
+            setIndex(index(position));
+        }
+    }
+
+    /// Clear the bit for a position.
+    ///
+    /// Positions outside this grid are ignored.
+    ///
+    void reset(const Position position) noexcept {
+        if (contains(position)) {
+            resetIndex(index(position));
+        }
+    }
+
+    void assign(const Position position, const bool value) noexcept {
+        if (value) {
+            set(position);
+        } else {
+            reset(position);
+        }
+    }
+
+    constexpr void setIndex(const std::size_t index) noexcept {
+        _words[index / 64U] |= uint64_t{1} << (index % 64U);
+    }
+
+    constexpr void resetIndex(const std::size_t index) noexcept {
+        _words[index / 64U] &= ~(uint64_t{1} << (index % 64U));
+    }
+
+    constexpr void clear() noexcept {
+        _words = {};
+    }
+
+public: // iteration
+    /// Call a function for each set position, in ascending position order.
+    ///
+    /// @param fn The visitor. If it returns `bool`, `false` stops the iteration.
+    /// @return `false` if the iteration was stopped.
+    ///
+    template<typename Fn>
+    auto forEach(Fn &&fn) const -> bool {
+        for (std::size_t wordIndex = 0; wordIndex < wordCount; ++wordIndex) {
+            auto word = _words[wordIndex];
+            while (word != 0) {
+                const auto bitIndex = static_cast<std::size_t>(std::countr_zero(word));
+                if (not utility::callVisitor(fn, position(wordIndex * 64U + bitIndex))) {
+                    return false;
+                }
+                word &= word - 1U;
+            }
+        }
+        return true;
+    }
+
+    /// Get all set positions as a list, in ascending position order.
+    ///
+    [[nodiscard]] auto toPositions() const noexcept -> PositionList {
+        PositionList result;
+        result.reserve(count());
+        forEach([&result](const Position position) { result.push_back(position); });
+        return result;
+    }
+
+    /// Get all set positions as an inline list, in ascending position order.
+    ///
+    [[nodiscard]] auto toFixedPositions() const noexcept -> FixedList<Position, bitCount> {
+        FixedList<Position, bitCount> result;
+        forEach([&result](const Position position) { result.push_back(position); });
+        return result;
+    }
+
+public: // conversion
+    /// Create a mask from a list of positions.
+    ///
+    /// Positions outside this grid are ignored.
+    ///
+    template<typename Range>
+    [[nodiscard]] static auto fromPositions(const Range &positions) noexcept -> PositionMask {
+        PositionMask result;
+        for (const Position position : positions) {
+            result.set(position);
+        }
+        return result;
+    }
+
+    /// Convert a mask from another grid into this grid.
+    ///
+    /// Positions that are not part of this grid are dropped.
+    ///
+    template<Length OtherN, Length OtherOffset>
+    [[nodiscard]] static auto from(const PositionMask<OtherN, OtherOffset> &other) noexcept -> PositionMask {
+        PositionMask result;
+        other.forEach([&result](const Position position) { result.set(position); });
+        return result;
+    }
+
+    [[nodiscard]] static auto index(const Position position) noexcept -> std::size_t {
+        return static_cast<std::size_t>(position.y() - Offset) * N + static_cast<std::size_t>(position.x() - Offset);
+    }
+
+    [[nodiscard]] static auto position(const std::size_t index) noexcept -> Position {
+        return Position{static_cast<Length>(index % N + Offset), static_cast<Length>(index / N + Offset)};
+    }
+
+public: // binary serialization
+    /// The number of bytes used by the binary form.
+    ///
+    static constexpr std::size_t binarySize = (bitCount + 7U) / 8U;
+
+    void addToBinary(std::string &data) const noexcept {
+        for (std::size_t i = 0; i < binarySize; ++i) {
+            data += static_cast<char>((_words[i / 8U] >> ((i % 8U) * 8U)) & 0xffU);
+        }
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> PositionMask {
+        Words words{};
+        for (std::size_t i = 0; i < binarySize; ++i) {
+            words[i / 8U] |= static_cast<uint64_t>(reader.readByte()) << ((i % 8U) * 8U);
+        }
+        return PositionMask{words};
+    }
+
+private:
+    constexpr void clearUnusedBits() noexcept {
+        if constexpr (bitCount % 64U != 0) {
+            _words[wordCount - 1] &= (uint64_t{1} << (bitCount % 64U)) - 1U;
+        }
+    }
+
+private:
+    Words _words{};
+};
+
+
+template<Length N, Length Offset>
+struct std::hash<PositionMask<N, Offset>> {
+    auto operator()(const PositionMask<N, Offset> &mask) const noexcept -> std::size_t {
+        return utility::hashFromArray(mask.words());
+    }
+};
+
@@ -5,6 +5,7 @@
 
 #include "Player.hpp"
 #include "RatingPlayer.hpp"
+#include "Rotation.hpp"
 
 
 /// Rating of a move or situation in general.
@@ -80,6 +81,19 @@ public: // modifiers
         *this += other;
     }
 
+    /// Permute the player ratings to match a rotated state.
+    ///
+    /// Rotating a state moves the player at index `i + rotation` to index `i`. The same happens to the ratings.
+    ///
+    void rotate(const Rotation rotation) noexcept {
+        const auto offset = static_cast<std::size_t>(rotation.wrapToClockwise().value());
+        RatingPerPlayer result{};
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            result.at(i) = _ratingsPerPlayer.at((i + offset) % result.size());
+        }
+        _ratingsPerPlayer = result;
+    }
+
 public: // conversion
     [[nodiscard]] auto toString(double totalGames) const noexcept -> std::string {
         std::string perPlayerStr;
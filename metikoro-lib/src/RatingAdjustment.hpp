@@ -18,6 +18,7 @@ public:
     static constexpr auto combinedDeltaForWin = ratingBase;
     static constexpr auto combinedDeltaForDraw = ratingBase / static_cast<double>(Player::count) * 0.1;
     static constexpr auto combinedDeltaForLoss = -ratingBase / static_cast<double>(Player::count - 1);
+    static constexpr auto drawsForDraw = ratingBase * static_cast<double>(Player::count);
 
 public:
     /// Zero adjustment.
@@ -33,10 +34,25 @@ public:
     constexpr RatingAdjustment(
         const GameTurn &turn,
         const std::size_t totalTurnCount,
+        const std::optional<Player> winningPlayer) noexcept
+        : RatingAdjustment(turn.turn, turn.activePlayer, totalTurnCount, winningPlayer) {
+    }
+
+    /// Create new score adjustments for the given turn number and active player.
+    ///
+    /// @param turn The turn number.
+    /// @param activePlayer The active player of the turn.
+    /// @param totalTurnCount The total turn count for the game.
+    /// @param winningPlayer The winning player, or no player if a draw.
+    ///
+    constexpr RatingAdjustment(
+        const std::size_t turn,
+        const Player activePlayer,
+        const std::size_t totalTurnCount,
         const std::optional<Player> winningPlayer) noexcept {
 
-        const auto factor = adjustmentFactor(turn.turn, totalTurnCount);
-        auto actualPlayer = turn.activePlayer;
+        const auto factor = adjustmentFactor(turn, totalTurnCount);
+        auto actualPlayer = activePlayer;
         for (uint8_t i = 0; i < Player::count; ++i, actualPlayer.next()) {
             if (not winningPlayer.has_value()) {
                 adjustDraws(ratingBase);
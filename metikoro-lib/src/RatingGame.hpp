@@ -11,6 +11,9 @@
 class RatingGame : public Rating {
 public:
     RatingGame() = default;
+    RatingGame(const uint64_t ratingCount, const Rating &rating) noexcept
+        : Rating{rating}, _ratingCount{ratingCount} {
+    }
 
 public: // accessors
     [[nodiscard]] auto ratingCount() const noexcept -> uint64_t { return _ratingCount; }
@@ -27,6 +30,13 @@ public: // modifiers
         add(adjustment);
     }
 
+    /// Add the ratings and the count of another game rating.
+    ///
+    void merge(const RatingGame &other) noexcept {
+        _ratingCount += other._ratingCount;
+        add(other);
+    }
+
 public: // conversion
     using Rating::toString;
     [[nodiscard]] auto toString() const noexcept -> std::string {
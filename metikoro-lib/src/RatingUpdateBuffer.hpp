@@ -0,0 +1,81 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "RatingAdjustment.hpp"
+#include "RatingGame.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/// A buffer that combines the rating adjustments of many games by state key.
+///
+/// States like the starting position repeat in nearly every game. The buffer merges all adjustments for
+/// the same key into one rating, so a backend only has to write each distinct state once per flush. The
+/// merged updates keep the order in which their states were first added, so the written order only
+/// depends on the order of the games.
+///
+/// The buffer is not thread safe.
+///
+class RatingUpdateBuffer {
+public:
+    /// A merged update for one state.
+    ///
+    struct Update {
+        std::string stateKey; ///< The key of the state.
+        RatingGame rating; ///< The merged adjustments, and their number as rating count.
+    };
+    using Updates = std::vector<Update>;
+
+public:
+    RatingUpdateBuffer() = default;
+
+public: // accessors
+    /// The number of distinct states in the buffer.
+    ///
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _ratings.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return _ratings.empty(); }
+
+    /// The number of adjustments that were added since the last flush.
+    ///
+    [[nodiscard]] auto adjustmentCount() const noexcept -> std::size_t { return _adjustmentCount; }
+
+public: // modifiers
+    /// Add the adjustment for a state.
+    ///
+    /// @param stateKey The key of the state, moved into the buffer if the state is new.
+    /// @param adjustment The adjustment.
+    ///
+    void add(std::string &&stateKey, const RatingAdjustment &adjustment) {
+        const auto [it, inserted] = _index.try_emplace(std::move(stateKey), _ratings.size());
+        if (inserted) {
+            _ratings.emplace_back();
+        }
+        _ratings[it->second].applyAdjustment(adjustment);
+        _adjustmentCount += 1;
+    }
+
+    /// Take all merged updates, in the order their states were first added, and clear the buffer.
+    ///
+    [[nodiscard]] auto take() -> Updates {
+        Updates result(_ratings.size());
+        // Extract the nodes, to move the keys instead of copying them.
+        while (not _index.empty()) {
+            auto node = _index.extract(_index.begin());
+            result[node.mapped()] = Update{std::move(node.key()), _ratings[node.mapped()]};
+        }
+        _ratings.clear();
+        _adjustmentCount = 0;
+        return result;
+    }
+
+private:
+    std::unordered_map<std::string, std::size_t> _index; ///< The index of the rating for each state key.
+    std::vector<RatingGame> _ratings; ///< The merged rating of each state, in the order they were added.
+    std::size_t _adjustmentCount{0}; ///< The number of added adjustments.
+};
+
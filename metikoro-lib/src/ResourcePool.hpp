@@ -5,16 +5,18 @@
 
 #include <numeric>
 
+#include "FixedList.hpp"
 #include "Setup.hpp"
 #include "StonePool.hpp"
+#include "Zobrist.hpp"
 
 
 class ResourcePool {
-    friend struct std::hash<ResourcePool>;
-
 public:
     constexpr static uint8_t size = Stone::count - 1;
     using StoneCounts = std::array<uint8_t, size>;
+    using Draws = FixedList<Stone, size>;
+    using DrawPairs = FixedList<StonePair, static_cast<std::size_t>(size) * (size + 1) / 2>;
 
 public:
     ResourcePool() = default;
@@ -25,6 +27,10 @@ public:
 
 public:
     [[nodiscard]] auto stoneCounts() const noexcept -> const StoneCounts& { return _stoneCounts; }
+
+    /// The Zobrist key for the stone counts.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key { return _key; }
     [[nodiscard]] auto empty() const noexcept -> bool {
         return std::ranges::all_of(_stoneCounts, [](const uint8_t count) { return count == 0; });
     }
@@ -36,7 +42,7 @@ public:
     }
 
     void add(const Stone stone, const uint8_t count = 1) noexcept {
-        at(stone) += count;
+        setCount(stone, at(stone) + count);
     }
 
     [[nodiscard]] auto withAdded(const Stone stone, const uint8_t count = 1) const noexcept -> ResourcePool {
@@ -49,7 +55,7 @@ public:
         if (count > at(stone)) {
             throw Error("ResourcePool::take - Cannot take more stones than available in the pool.");
         }
-        at(stone) -= count;
+        setCount(stone, at(stone) - count);
     }
 
     [[nodiscard]] auto withTaken(const Stone stone, const uint8_t count = 1) const noexcept -> ResourcePool {
@@ -58,14 +64,12 @@ public:
         return result;
     }
 
-    [[nodiscard]] auto allActionOneExtraDraw() const noexcept -> StoneList {
-        return Stone::allNonEmpty()
-            | std::views::filter([this](const Stone& stone) { return hasStone(stone); })
-            | std::ranges::to<std::vector>();
+    [[nodiscard]] auto allActionOneExtraDraw() const noexcept -> Draws {
+        return availableStones();
     }
 
-    [[nodiscard]] auto allActionTwoExtraDraws() const noexcept -> StonePairList {
-        StonePairList result;
+    [[nodiscard]] auto allActionTwoExtraDraws() const noexcept -> DrawPairs {
+        DrawPairs result;
         for (const auto stoneA : Stone::allNonEmpty()) {
             for (const auto stoneB : Stone::allNonEmpty()) {
                 if (stoneA == stoneB) {
@@ -82,13 +86,19 @@ public:
         return result;
     }
 
-    [[nodiscard]] auto allRegularDraws() const noexcept -> StoneList {
-        if (empty()) {
-            return {};
+    [[nodiscard]] auto allRegularDraws() const noexcept -> Draws {
+        return availableStones();
+    }
+
+private:
+    [[nodiscard]] auto availableStones() const noexcept -> Draws {
+        Draws result;
+        for (const auto stone : Stone::allNonEmpty()) {
+            if (hasStone(stone)) {
+                result.push_back(stone);
+            }
         }
-        return Stone::allNonEmpty()
-            | std::views::filter([this](const Stone& stone) { return hasStone(stone); })
-            | std::ranges::to<std::vector>();
+        return result;
     }
 
 public: // serialization
@@ -108,7 +118,43 @@ public: // serialization
         }
         ResourcePool result;
         for (std::size_t i = 0; i < result._stoneCounts.size(); ++i) {
-            result._stoneCounts.at(i) = utility::hexStringToByte(data.substr(i * 2U, 2U));
+            result.setCount(Stone{static_cast<uint8_t>(i + 1)}, utility::hexStringToByte(data.substr(i * 2U, 2U)));
+        }
+        return result;
+    }
+
+public: // binary serialization
+    /// Add the resource pool in its binary form.
+    ///
+    /// A 16-bit mask of the stones with a non-zero count is followed by one byte for each of these counts.
+    ///
+    void addToBinary(std::string &data) const noexcept {
+        uint16_t mask = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (_stoneCounts[i] != 0) {
+                mask |= static_cast<uint16_t>(1U << i);
+            }
+        }
+        data += static_cast<char>(mask & 0xffU);
+        data += static_cast<char>(mask >> 8U);
+        for (const auto count : _stoneCounts) {
+            if (count != 0) {
+                data += static_cast<char>(count);
+            }
+        }
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> ResourcePool {
+        const auto lowByte = reader.readByte();
+        const auto mask = static_cast<uint16_t>(lowByte | (reader.readByte() << 8U));
+        if ((mask >> size) != 0) {
+            throw Error("ResourcePool: Invalid stone mask in binary data.");
+        }
+        ResourcePool result;
+        for (std::size_t i = 0; i < size; ++i) {
+            if ((mask & (1U << i)) != 0) {
+                result.setCount(Stone{static_cast<uint8_t>(i + 1)}, reader.readByte());
+            }
         }
         return result;
     }
@@ -129,17 +175,25 @@ private:
         return _stoneCounts.at(index);
     }
 
+    void setCount(const Stone stone, const uint8_t count) noexcept {
+        auto &value = at(stone);
+        _key ^= zobrist::resourceCountKey(stone, value) ^ zobrist::resourceCountKey(stone, count);
+        value = count;
+    }
+
 private:
     StoneCounts _stoneCounts{};
+    zobrist::Key _key{}; ///< Derived from `_stoneCounts`.
 };
 
 
 static_assert(Serializable<ResourcePool>);
+static_assert(BinarySerializable<ResourcePool>);
 
 
 template<>
 struct std::hash<ResourcePool> {
     auto operator()(const ResourcePool &resourcePool) const noexcept -> std::size_t {
-        return utility::hashFromArray(resourcePool._stoneCounts);
+        return resourcePool.zobristKey();
     }
 };
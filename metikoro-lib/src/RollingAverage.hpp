@@ -3,36 +3,57 @@
 #pragma once
 
 
-#include <numeric>
-#include <vector>
+#include <array>
+#include <cstddef>
+#include <type_traits>
 
 
+/// The average of the last `MAX_N` values.
+///
+/// The values are kept in a ring buffer with a running sum, so adding a value takes constant time.
+///
 template <typename T, std::size_t MAX_N>
 class RollingAverage {
     static_assert(MAX_N > 0);
     static_assert(std::is_floating_point_v<T>);
 
 public:
-    using Values = std::vector<T>;
+    using Values = std::array<T, MAX_N>;
 
 public:
     RollingAverage() = default;
 
 public:
     void add(const T value) noexcept {
-        _values.push_back(value);
-        if (_values.size() > MAX_N) {
-            _values.erase(_values.begin());
+        if (_count == MAX_N) {
+            _sum -= _values[_next];
+        } else {
+            _count += 1;
+        }
+        _values[_next] = value;
+        _sum += value;
+        _next = (_next + 1) % MAX_N;
+        if (_next == 0) {
+            // Recalculate the sum once per round, so rounding errors do not accumulate.
+            _sum = 0;
+            for (std::size_t i = 0; i < _count; ++i) {
+                _sum += _values[i];
+            }
         }
-        _average = std::accumulate(_values.begin(), _values.end(), 0.0) / static_cast<T>(_values.size());
     }
 
     [[nodiscard]] auto average() const noexcept -> T {
-        return _average;
+        return _count > 0 ? _sum / static_cast<T>(_count) : T{0};
+    }
+
+    [[nodiscard]] auto count() const noexcept -> std::size_t {
+        return _count;
     }
 
 private:
-    T _average = 0;
-    Values _values{};
+    Values _values{}; ///< The ring buffer with the last values.
+    T _sum{0}; ///< The sum of all values in the buffer.
+    std::size_t _count{0}; ///< The number of values in the buffer.
+    std::size_t _next{0}; ///< The index for the next value.
 };
 
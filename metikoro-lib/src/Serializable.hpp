@@ -3,6 +3,8 @@
 #pragma once
 
 
+#include "BinaryReader.hpp"
+
 #include <concepts>
 #include <string>
 #include <string_view>
@@ -15,3 +17,10 @@ concept Serializable = requires(T obj, std::string& str, std::string_view data)
     { T::fromData(data) } -> std::same_as<T>;
 };
 
+
+template <typename T>
+concept BinarySerializable = requires(T obj, std::string& bytes, BinaryReader& reader) {
+    { obj.addToBinary(bytes) } noexcept;
+    { T::fromBinary(reader) } -> std::same_as<T>;
+};
+
@@ -0,0 +1,74 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Agent.hpp"
+#include "GameArena.hpp"
+#include "GameSimulator.hpp"
+#include "Utilities.hpp"
+
+#include <cstdint>
+
+
+/// Everything a thread of the simulation reuses from game to game.
+///
+/// The context owns its own copy of the agents, a game simulator and a game arena. Only one game runs in a
+/// context at a time, so its buffers are never shared. After the first few games, the buffers reached their
+/// steady size, and a game runs without allocating memory from the heap.
+///
+class SimulationContext {
+public:
+    /// Create a new context.
+    ///
+    /// @param configuredAgents The configured agents. Each is copied using `copyForThread()`.
+    ///
+    explicit SimulationContext(const PlayerAgents &configuredAgents)
+        : _agents{copyAgents(configuredAgents)}, _simulator{_agents} {
+    }
+
+    SimulationContext(const SimulationContext&) = delete;
+    auto operator=(const SimulationContext&) -> SimulationContext& = delete;
+
+public:
+    [[nodiscard]] auto agents() const noexcept -> const PlayerAgents& { return _agents; }
+    [[nodiscard]] auto simulator() noexcept -> GameSimulator& { return _simulator; }
+    [[nodiscard]] auto arena() noexcept -> GameArena& { return _arena; }
+
+    /// Run one game in this context.
+    ///
+    /// The arena of the context is active while the agents play, and released when the game ended.
+    ///
+    /// @param gameSeed The seed of the game, or zero, if the game is not reproducible.
+    /// @return The log of the game, valid until the next game runs in this context.
+    ///
+    auto runGame(const uint64_t gameSeed) -> const GameLog& {
+        {
+            GameArena::Scope const scope{_arena};
+            for (std::size_t i = 0; i < _agents.size(); ++i) {
+                _agents[i]->gameStart(gameSeed != 0 ? utility::deriveSeed(gameSeed, i) : uint64_t{0});
+            }
+            _simulator.run();
+            for (const auto &agent : _agents) {
+                agent->gameEnd(_simulator.gameLog());
+            }
+        }
+        _arena.release();
+        return _simulator.gameLog();
+    }
+
+private:
+    [[nodiscard]] static auto copyAgents(const PlayerAgents &configuredAgents) noexcept -> PlayerAgents {
+        PlayerAgents result;
+        for (std::size_t i = 0; i < configuredAgents.size(); ++i) {
+            result[i] = configuredAgents[i]->copyForThread();
+        }
+        return result;
+    }
+
+private:
+    PlayerAgents _agents; ///< The copies of the agents for this context.
+    GameSimulator _simulator; ///< The simulator, reused for all games.
+    GameArena _arena; ///< The arena for the temporary containers of a game.
+};
+
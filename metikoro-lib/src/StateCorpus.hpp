@@ -0,0 +1,112 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "AgentRandom.hpp"
+#include "Error.hpp"
+#include "GameSimulator.hpp"
+#include "GameState.hpp"
+
+#include <array>
+#include <cstdint>
+#include <format>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// A list of game states, used to measure and verify the move generation.
+///
+/// All states are in the view of the active player, so player 0 is always the active player. In text form,
+/// each line starts with the `toData()` string of one state. Anything after the first space, empty lines and
+/// lines starting with `#` are ignored, so files with additional columns can be read as corpus.
+///
+class StateCorpus {
+public:
+    using States = std::vector<GameState>;
+
+public:
+    StateCorpus() = default;
+    explicit StateCorpus(States states) noexcept : _states{std::move(states)} {}
+
+public: // accessors
+    [[nodiscard]] auto states() const noexcept -> const States& { return _states; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _states.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return _states.empty(); }
+    [[nodiscard]] auto begin() const noexcept -> States::const_iterator { return _states.begin(); }
+    [[nodiscard]] auto end() const noexcept -> States::const_iterator { return _states.end(); }
+
+public: // modifiers
+    void add(const GameState &state) noexcept { _states.emplace_back(state); }
+
+public: // text form
+    /// Read a corpus in text form.
+    ///
+    /// @throws Error if a line contains no valid state.
+    ///
+    [[nodiscard]] static auto fromStream(std::istream &input) -> StateCorpus {
+        StateCorpus result;
+        std::string line;
+        while (std::getline(input, line)) {
+            const auto data = std::string_view{line}.substr(0, line.find_first_of(" \t\r"));
+            if (data.empty() or data.starts_with('#')) {
+                continue;
+            }
+            result.add(GameState::fromData(data));
+        }
+        return result;
+    }
+
+    /// Write the corpus in text form.
+    ///
+    void writeTo(std::ostream &output) const {
+        for (const auto &state : _states) {
+            output << state.toData() << "\n";
+        }
+    }
+
+public: // generation
+    /// Create a corpus from random playouts.
+    ///
+    /// Games with random agents are simulated from the starting state, and the state of every turn is added,
+    /// until the corpus has the requested size. The result only depends on the seed.
+    ///
+    /// @param count The number of states.
+    /// @param seed The seed for the random agents. Must not be zero.
+    ///
+    [[nodiscard]] static auto fromRandomPlayouts(const std::size_t count, const uint64_t seed) -> StateCorpus {
+        if (seed == 0) {
+            throw Error("StateCorpus: The seed for random playouts must not be zero.");
+        }
+        StateCorpus result;
+        result._states.reserve(count);
+        for (uint64_t game = 0; result.size() < count; ++game) {
+            PlayerAgents agents{};
+            for (std::size_t i = 0; i < agents.size(); ++i) {
+                auto agent = std::make_shared<AgentRandom>();
+                auto seedArg = std::format("--seed={}", seed + (game * Player::count) + i);
+                std::array<std::string_view, 1> args{seedArg};
+                agent->initialize(args);
+                agents[i] = agent;
+            }
+            auto simulator = GameSimulator{agents};
+            simulator.run();
+            const auto &gameLog = simulator.gameLog();
+            // The last entry is the final state of the game, without a move.
+            for (const auto &turn : gameLog) {
+                if (turn.turn + 1 >= gameLog.size() or result.size() >= count) {
+                    break;
+                }
+                result.add(turn.playerState());
+            }
+        }
+        return result;
+    }
+
+private:
+    States _states;
+};
+
@@ -0,0 +1,61 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "GameState.hpp"
+#include "Zobrist.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+/// A 128-bit fingerprint of a game state.
+///
+/// The high part is the Zobrist key of the state, the low part is a hash of its binary encoding. The two
+/// parts are independent, so two different states only get the same fingerprint with a probability of
+/// about 2^-128, and the fingerprint can replace the state as key of a table.
+///
+struct StateFingerprint {
+    uint64_t high{0}; ///< The Zobrist key of the state.
+    uint64_t low{0}; ///< The hash of the binary encoding of the state.
+
+    [[nodiscard]] auto operator==(const StateFingerprint &other) const noexcept -> bool = default;
+
+    /// Create the fingerprint of a state.
+    ///
+    /// @param state The state.
+    /// @param buffer A buffer for the binary encoding, that can be reused to avoid allocations.
+    ///
+    [[nodiscard]] static auto fromState(const GameState &state, std::string &buffer) noexcept -> StateFingerprint {
+        buffer.clear();
+        state.addToBinary(buffer);
+        return StateFingerprint{state.zobristKey(), hashBytes(buffer)};
+    }
+
+    /// Create the fingerprint of a state.
+    ///
+    [[nodiscard]] static auto fromState(const GameState &state) noexcept -> StateFingerprint {
+        std::string buffer;
+        return fromState(state, buffer);
+    }
+
+private:
+    [[nodiscard]] static auto hashBytes(const std::string &data) noexcept -> uint64_t {
+        auto result = zobrist::mix(data.size());
+        std::size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= data.size(); offset += sizeof(uint64_t)) {
+            uint64_t word{};
+            std::memcpy(&word, data.data() + offset, sizeof(uint64_t));
+            result = zobrist::mix(result ^ word);
+        }
+        if (offset < data.size()) {
+            uint64_t word{};
+            std::memcpy(&word, data.data() + offset, data.size() - offset);
+            result = zobrist::mix(result ^ word);
+        }
+        return result;
+    }
+};
+
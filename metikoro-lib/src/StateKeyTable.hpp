@@ -0,0 +1,114 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Zobrist.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/// A set of 64-bit state keys, using open addressing with linear probing.
+///
+/// Used to detect repeated states in a game. Only the keys are stored, so inserting a key never allocates,
+/// unless the table has to grow. Clearing the table keeps its capacity, so a table that is reused for many
+/// games reaches a steady size and stops allocating memory.
+///
+class StateKeyTable {
+public:
+    using Key = zobrist::Key;
+
+    /// The initial number of slots.
+    constexpr static std::size_t initialCapacity = 256;
+
+public:
+    StateKeyTable() = default;
+
+public:
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _size; }
+    [[nodiscard]] auto empty() const noexcept -> bool { return _size == 0; }
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t { return _slots.size(); }
+
+    /// Test if the table contains a key.
+    ///
+    [[nodiscard]] auto contains(const Key key) const noexcept -> bool {
+        if (key == emptySlot) {
+            return _hasEmptySlotKey;
+        }
+        if (_slots.empty()) {
+            return false;
+        }
+        for (auto index = slotIndex(key); ; index = (index + 1) & mask()) {
+            if (_slots[index] == key) {
+                return true;
+            }
+            if (_slots[index] == emptySlot) {
+                return false;
+            }
+        }
+    }
+
+    /// Insert a key.
+    ///
+    /// @return `true` if the key was inserted, `false` if the table already contained it.
+    ///
+    auto insert(const Key key) -> bool {
+        if (key == emptySlot) {
+            return not std::exchange(_hasEmptySlotKey, true);
+        }
+        if ((_size + 1) * 2 > _slots.size()) {
+            grow();
+        }
+        for (auto index = slotIndex(key); ; index = (index + 1) & mask()) {
+            if (_slots[index] == key) {
+                return false;
+            }
+            if (_slots[index] == emptySlot) {
+                _slots[index] = key;
+                _size += 1;
+                return true;
+            }
+        }
+    }
+
+    /// Remove all keys, but keep the capacity.
+    ///
+    void clear() noexcept {
+        if (_size > 0) {
+            std::ranges::fill(_slots, emptySlot);
+        }
+        _size = 0;
+        _hasEmptySlotKey = false;
+    }
+
+private:
+    /// The value of an empty slot. A key with this value is stored in a separate flag.
+    constexpr static Key emptySlot = 0;
+
+    [[nodiscard]] auto mask() const noexcept -> std::size_t { return _slots.size() - 1; }
+
+    [[nodiscard]] auto slotIndex(const Key key) const noexcept -> std::size_t {
+        // The keys are already uniformly distributed, so the lowest bits are used directly.
+        return static_cast<std::size_t>(key) & mask();
+    }
+
+    void grow() {
+        auto oldSlots = std::move(_slots);
+        _slots.assign(oldSlots.empty() ? initialCapacity : oldSlots.size() * 2, emptySlot);
+        _size = 0;
+        for (const auto key : oldSlots) {
+            if (key != emptySlot) {
+                insert(key);
+            }
+        }
+    }
+
+private:
+    std::vector<Key> _slots; ///< The slots, with a power-of-two size.
+    std::size_t _size{0}; ///< The number of keys in the slots.
+    bool _hasEmptySlotKey{false}; ///< If the key with the value of an empty slot was inserted.
+};
+
@@ -0,0 +1,302 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Error.hpp"
+#include "MappedFile.hpp"
+#include "StateRatingTable.hpp"
+#include "StateRatingView.hpp"
+
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/// A snapshot file with the rating tables of all shards of the memory backend.
+///
+/// The file stores the arrays of each table exactly as they are kept in memory, including the slots. A
+/// snapshot is therefore not parsed when it is opened: The file is mapped into memory, only the header and
+/// the shard directory are validated, and the tables are read in place through a `StateRatingView`.
+///
+/// File layout, in native byte order:
+///
+/// - `Header`: magic, version, byte order mark, record size, flags, shard and record count. The flags
+///   store the state form and the precision of the combined ratings.
+/// - `ShardEntry` for each shard: offset, record count and slot count.
+/// - For each shard, at an offset aligned to `alignment`: the fingerprints, rating counts, draw counts,
+///   win counts, combined ratings and slots, each array aligned to `alignment`.
+///
+/// A snapshot is written to a temporary file, synced, and renamed over the previous snapshot, so the file
+/// is always either the old or the new complete snapshot.
+///
+class StateRatingSnapshot {
+public:
+    /// The magic bytes at the start of a snapshot file.
+    constexpr static std::array<char, 8> magic{'M', 'K', 'R', 'S', 'N', 'A', 'P', '\0'};
+    /// The current version of the file format.
+    constexpr static uint32_t currentVersion = 3;
+    /// The value to detect files written with another byte order.
+    constexpr static uint32_t byteOrderMark = 0x01020304;
+    /// The alignment of the shards and arrays in the file.
+    constexpr static std::size_t alignment = 64;
+    /// The flag for snapshots of canonical states.
+    constexpr static uint32_t flagCanonicalStates = 1;
+    /// The flag for snapshots with the combined ratings stored as 32-bit floats.
+    constexpr static uint32_t flagFloatRatings = 2;
+
+    /// The header at the start of the file.
+    ///
+    struct Header {
+        std::array<char, 8> magic; ///< The magic bytes.
+        uint32_t version; ///< The version of the file format.
+        uint32_t byteOrder; ///< The byte order mark.
+        uint32_t bytesPerRecord; ///< The number of bytes per record, to detect changed record layouts.
+        uint32_t flags; ///< The flags of the snapshot.
+        uint64_t shardCount; ///< The number of shards.
+        uint64_t recordCount; ///< The total number of records in all shards.
+    };
+
+    /// The entry for one shard in the shard directory.
+    ///
+    struct ShardEntry {
+        uint64_t offset; ///< The offset of the first array of the shard in the file.
+        uint64_t recordCount; ///< The number of records in the shard.
+        uint64_t slotCount; ///< The number of slots in the shard.
+    };
+
+    static_assert(sizeof(Header) == 40);
+    static_assert(sizeof(ShardEntry) == 24);
+
+    /// A function that creates the table to write for a shard.
+    using ShardFn = std::function<StateRatingTable(std::size_t shardIndex)>;
+
+public:
+    /// Open and validate a snapshot file.
+    ///
+    /// @throws Error If the file can not be mapped, or is no valid snapshot.
+    ///
+    explicit StateRatingSnapshot(const std::filesystem::path &path) : _file{path} {
+        const auto fail = [&path](const std::string_view message) {
+            return Error{std::format("Invalid snapshot file: {}: {}", path.string(), message)};
+        };
+        if (_file.size() < sizeof(Header)) {
+            throw fail("The file is too small");
+        }
+        Header header{};
+        std::memcpy(&header, _file.data(), sizeof(Header));
+        if (header.magic != magic) {
+            throw fail("Unknown file format");
+        }
+        if (header.byteOrder != byteOrderMark) {
+            throw fail("The file was written with another byte order");
+        }
+        if (header.version != currentVersion) {
+            throw fail(std::format("Unsupported version {}", header.version));
+        }
+        _precision = (header.flags & flagFloatRatings) != 0 ? RatingPrecision::Float : RatingPrecision::Double;
+        if (header.bytesPerRecord != StateRatingTable::bytesPerRecord(_precision)) {
+            throw fail("The record layout does not match");
+        }
+        if (not std::has_single_bit(header.shardCount)
+                or header.shardCount > (_file.size() - sizeof(Header)) / sizeof(ShardEntry)) {
+            throw fail("Invalid shard count");
+        }
+        _canonicalStates = (header.flags & flagCanonicalStates) != 0;
+        _recordCount = header.recordCount;
+        std::vector<ShardEntry> directory(header.shardCount);
+        std::memcpy(directory.data(), _file.data() + sizeof(Header), directory.size() * sizeof(ShardEntry));
+        uint64_t recordCount = 0;
+        _shards.reserve(directory.size());
+        for (const auto &entry : directory) {
+            if (entry.recordCount >= StateRatingView::emptySlot
+                    or entry.slotCount > (uint64_t{1} << 40)
+                    or (entry.slotCount == 0 and entry.recordCount > 0)
+                    or (entry.slotCount > 0 and entry.slotCount <= entry.recordCount)
+                    or entry.offset % alignment != 0
+                    or entry.offset > _file.size()) {
+                throw fail(std::format("Invalid entry for shard {}", _shards.size()));
+            }
+            const auto offsets = arrayOffsets(entry.recordCount, entry.slotCount, _precision);
+            if (offsets.back() > _file.size() - entry.offset) {
+                throw fail(std::format("Shard {} exceeds the file", _shards.size()));
+            }
+            const auto *shardData = _file.data() + entry.offset;
+            _shards.emplace_back(
+                entry.recordCount,
+                reinterpret_cast<const StateFingerprint*>(shardData + offsets[0]),
+                reinterpret_cast<const uint32_t*>(shardData + offsets[1]),
+                reinterpret_cast<const uint32_t*>(shardData + offsets[2]),
+                reinterpret_cast<const StateRatingView::Counters*>(shardData + offsets[3]),
+                _precision == RatingPrecision::Double
+                    ? reinterpret_cast<const StateRatingView::Combined*>(shardData + offsets[4]) : nullptr,
+                _precision == RatingPrecision::Float
+                    ? reinterpret_cast<const StateRatingView::CompactCombined*>(shardData + offsets[4]) : nullptr,
+                entry.slotCount,
+                reinterpret_cast<const StateRatingView::Index*>(shardData + offsets[5]));
+            recordCount += entry.recordCount;
+        }
+        if (recordCount != _recordCount) {
+            throw fail("The record count does not match the shards");
+        }
+    }
+
+    /// Open and validate a snapshot file.
+    ///
+    /// @throws Error If the file can not be mapped, or is no valid snapshot.
+    ///
+    [[nodiscard]] static auto open(const std::filesystem::path &path) -> std::shared_ptr<const StateRatingSnapshot> {
+        return std::make_shared<const StateRatingSnapshot>(path);
+    }
+
+public: // accessors
+    [[nodiscard]] auto shardCount() const noexcept -> std::size_t { return _shards.size(); }
+    [[nodiscard]] auto recordCount() const noexcept -> std::size_t { return _recordCount; }
+    [[nodiscard]] auto canonicalStates() const noexcept -> bool { return _canonicalStates; }
+    [[nodiscard]] auto precision() const noexcept -> RatingPrecision { return _precision; }
+    [[nodiscard]] auto fileSize() const noexcept -> std::size_t { return _file.size(); }
+
+    /// Access the table of a shard.
+    ///
+    /// The view is valid as long as this snapshot exists.
+    ///
+    [[nodiscard]] auto shard(const std::size_t index) const noexcept -> const StateRatingView& {
+        return _shards[index];
+    }
+
+public:
+    /// Write a new snapshot file.
+    ///
+    /// The tables are requested one after the other, so only one of them has to be kept in memory. All
+    /// tables must use the same precision, that is stored in the snapshot.
+    ///
+    /// @param path The path of the snapshot file, that is replaced when the new snapshot is complete.
+    /// @param shardCount The number of shards, a power of two.
+    /// @param canonicalStates If the tables contain canonical states.
+    /// @param shardFn The function that creates the table for each shard.
+    /// @throws Error If the file can not be written, or the tables use different precisions.
+    ///
+    static void write(
+        const std::filesystem::path &path,
+        const std::size_t shardCount,
+        const bool canonicalStates,
+        const ShardFn &shardFn) {
+
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+        Header header{
+            magic,
+            currentVersion,
+            byteOrderMark,
+            static_cast<uint32_t>(StateRatingTable::bytesPerRecord(RatingPrecision::Double)),
+            canonicalStates ? flagCanonicalStates : 0,
+            shardCount,
+            0};
+        std::vector<ShardEntry> directory(shardCount);
+        {
+            std::ofstream output{temporaryPath, std::ios::binary | std::ios::trunc};
+            if (not output) {
+                throw Error{std::format("Could not open the snapshot file for writing: {}", temporaryPath.string())};
+            }
+            // Write the header and directory twice, as the entries are only known after writing the shards.
+            const auto writeHeader = [&]() {
+                output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+                output.write(reinterpret_cast<const char*>(directory.data()),
+                    static_cast<std::streamsize>(directory.size() * sizeof(ShardEntry)));
+            };
+            writeHeader();
+            std::size_t offset = sizeof(Header) + directory.size() * sizeof(ShardEntry);
+            for (std::size_t i = 0; i < shardCount; ++i) {
+                const auto padding = (alignment - offset % alignment) % alignment;
+                constexpr std::array<char, alignment> zeros{};
+                output.write(zeros.data(), static_cast<std::streamsize>(padding));
+                offset += padding;
+                const auto table = shardFn(i);
+                if (i == 0 and table.precision() == RatingPrecision::Float) {
+                    header.flags |= flagFloatRatings;
+                    header.bytesPerRecord = static_cast<uint32_t>(StateRatingTable::bytesPerRecord(RatingPrecision::Float));
+                } else if (table.precision() != ((header.flags & flagFloatRatings) != 0
+                        ? RatingPrecision::Float : RatingPrecision::Double)) {
+                    throw Error{"The tables of a snapshot must use the same precision."};
+                }
+                directory[i] = ShardEntry{offset, table.size(), table.slotCount()};
+                header.recordCount += table.size();
+                offset += table.writeArrays(output, alignment);
+            }
+            output.seekp(0);
+            writeHeader();
+            output.close();
+            if (not output) {
+                throw Error{std::format("Could not write the snapshot file: {}", temporaryPath.string())};
+            }
+        }
+        syncPath(temporaryPath);
+        std::error_code errorCode;
+        std::filesystem::rename(temporaryPath, path, errorCode);
+        if (errorCode) {
+            throw Error{std::format("Could not replace the snapshot file: {}: {}", path.string(), errorCode.message())};
+        }
+        syncPath(path.parent_path().empty() ? std::filesystem::path{"."} : path.parent_path());
+    }
+
+private:
+    /// Get the offsets of the arrays of a shard, relative to its start, and the end of the last array.
+    ///
+    [[nodiscard]] static auto arrayOffsets(
+        const uint64_t recordCount,
+        const uint64_t slotCount,
+        const RatingPrecision precision) noexcept -> std::array<uint64_t, 7> {
+
+        const std::array<uint64_t, 6> arraySizes{
+            recordCount * sizeof(StateFingerprint),
+            recordCount * sizeof(uint32_t),
+            recordCount * sizeof(uint32_t),
+            recordCount * sizeof(StateRatingView::Counters),
+            recordCount * (precision == RatingPrecision::Float
+                ? sizeof(StateRatingView::CompactCombined) : sizeof(StateRatingView::Combined)),
+            slotCount * sizeof(StateRatingView::Index)};
+        std::array<uint64_t, 7> result{};
+        uint64_t offset = 0;
+        for (std::size_t i = 0; i < arraySizes.size(); ++i) {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            result[i] = offset;
+            offset += arraySizes[i];
+        }
+        result[6] = offset;
+        return result;
+    }
+
+    /// Flush a file or directory to the disk.
+    ///
+    static void syncPath(const std::filesystem::path &path) {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw Error{std::format("Could not open for sync: {}: {}", path.string(), std::strerror(errno))};
+        }
+        const auto result = ::fsync(fd);
+        const auto syncError = errno;
+        ::close(fd);
+        if (result != 0) {
+            throw Error{std::format("Could not sync: {}: {}", path.string(), std::strerror(syncError))};
+        }
+    }
+
+private:
+    MappedFile _file; ///< The mapped file.
+    bool _canonicalStates{false}; ///< If the snapshot contains canonical states.
+    RatingPrecision _precision{RatingPrecision::Double}; ///< The precision of the combined ratings.
+    std::size_t _recordCount{0}; ///< The total number of records.
+    std::vector<StateRatingView> _shards; ///< The view of the table of each shard.
+};
+
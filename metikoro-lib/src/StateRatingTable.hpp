@@ -0,0 +1,259 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Error.hpp"
+#include "Player.hpp"
+#include "RatingAdjustment.hpp"
+#include "RatingGame.hpp"
+#include "StateFingerprint.hpp"
+#include "StateRatingView.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+
+/// A compact table with the accumulated ratings of states, keyed by state fingerprints.
+///
+/// The records are stored densely in a structure-of-arrays layout, and an open-addressing slot array with
+/// linear probing maps the fingerprints to the records. Instead of the full rating, a record only keeps
+/// what the adjustments of a game can change:
+///
+/// - the number of ratings, draws and wins per player as exact integer counters. The losses are the
+///   ratings that were neither a draw nor a win.
+/// - the combined rating per player, weighted by the turn, as 64-bit float.
+///
+/// A record needs `bytesPerRecord()` (72) bytes, plus 5.3 bytes for its slots, as the slots are sized
+/// exactly for a load of 3/4 of the reserved records. Without a reservation, the table grows by half of
+/// its capacity at a time, so up to a third of the reserved records are unused.
+///
+/// With `RatingPrecision::Float`, the combined ratings are stored as 32-bit floats, and a record needs 56
+/// bytes. The sums of frequent states, like the start state, grow with every game. A 32-bit float only
+/// keeps about seven significant digits, so once such a sum reaches 1e5 to 1e6, small adjustments like
+/// draws are mostly lost to rounding. Snapshots keep the sums between runs, so this error accumulates.
+///
+/// Lookups are done through a `StateRatingView` of the arrays, that can also read a memory mapped snapshot.
+/// @see StateRatingSnapshot
+///
+class StateRatingTable {
+public:
+    using Index = StateRatingView::Index;
+    using Counters = StateRatingRecord::Counters;
+    using Combined = StateRatingRecord::Combined;
+    using CompactCombined = StateRatingRecord::CompactCombined;
+
+    /// The number of bytes per record, for the given precision of the combined ratings.
+    ///
+    [[nodiscard]] constexpr static auto bytesPerRecord(const RatingPrecision precision) noexcept -> std::size_t {
+        return sizeof(StateFingerprint) + 2 * sizeof(uint32_t) + sizeof(Counters)
+            + (precision == RatingPrecision::Float ? sizeof(CompactCombined) : sizeof(Combined));
+    }
+
+    /// The initial number of reserved records.
+    constexpr static std::size_t initialCapacity = 768;
+
+public:
+    /// Create an empty table.
+    ///
+    /// @param precision The precision of the stored combined ratings.
+    ///
+    explicit StateRatingTable(const RatingPrecision precision = RatingPrecision::Double) noexcept
+        : _precision{precision} {
+    }
+
+public: // accessors
+    [[nodiscard]] auto precision() const noexcept -> RatingPrecision { return _precision; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _fingerprints.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return _fingerprints.empty(); }
+    [[nodiscard]] auto slotCount() const noexcept -> std::size_t { return _slots.size(); }
+
+    /// The allocated memory of the table, in bytes.
+    ///
+    [[nodiscard]] auto memoryUse() const noexcept -> std::size_t {
+        return _fingerprints.capacity() * bytesPerRecord(_precision) + _slots.size() * sizeof(Index);
+    }
+
+    /// A read-only view of this table, that is valid until the table is modified.
+    ///
+    [[nodiscard]] auto view() const noexcept -> StateRatingView {
+        return StateRatingView{size(), _fingerprints.data(), _ratingCounts.data(), _drawCounts.data(),
+            _winCounts.data(), isCompact() ? nullptr : _combined.data(),
+            isCompact() ? _compactCombined.data() : nullptr, _slots.size(), _slots.data()};
+    }
+
+    /// Get the accumulated rating of a state.
+    ///
+    /// @return The rating, or no value if the state has no rating.
+    ///
+    [[nodiscard]] auto rating(const StateFingerprint &fingerprint) const noexcept -> std::optional<RatingGame> {
+        return view().rating(fingerprint);
+    }
+
+    /// Write the arrays of the table, in the layout of a snapshot shard.
+    ///
+    /// @param output The output stream, positioned at the start of the shard.
+    /// @param alignment The alignment of each array, relative to the start of the shard.
+    /// @return The number of written bytes.
+    ///
+    auto writeArrays(std::ostream &output, const std::size_t alignment) const -> std::size_t {
+        std::size_t offset = 0;
+        const auto writeArray = [&]<typename T>(const std::vector<T> &values) {
+            const auto padding = (alignment - offset % alignment) % alignment;
+            constexpr std::array<char, 64> zeros{};
+            output.write(zeros.data(), static_cast<std::streamsize>(padding));
+            output.write(reinterpret_cast<const char*>(values.data()),
+                static_cast<std::streamsize>(values.size() * sizeof(T)));
+            offset += padding + values.size() * sizeof(T);
+        };
+        writeArray(_fingerprints);
+        writeArray(_ratingCounts);
+        writeArray(_drawCounts);
+        writeArray(_winCounts);
+        if (isCompact()) {
+            writeArray(_compactCombined);
+        } else {
+            writeArray(_combined);
+        }
+        writeArray(_slots);
+        return offset;
+    }
+
+public: // modifiers
+    /// Reserve memory for the given number of records.
+    ///
+    /// The slots are sized for this number of records, so the table does not grow until it is exceeded.
+    ///
+    void reserve(const std::size_t recordCount) {
+        if (recordCount <= _fingerprints.capacity() and not _slots.empty()) {
+            return;
+        }
+        _fingerprints.reserve(recordCount);
+        _ratingCounts.reserve(recordCount);
+        _drawCounts.reserve(recordCount);
+        _winCounts.reserve(recordCount);
+        if (isCompact()) {
+            _compactCombined.reserve(recordCount);
+        } else {
+            _combined.reserve(recordCount);
+        }
+        const auto slotCount = slotCountFor(_fingerprints.capacity());
+        if (slotCount > _slots.size()) {
+            rebuildSlots(slotCount);
+        }
+    }
+
+    /// Apply the adjustment of one game to the rating of a state.
+    ///
+    void applyAdjustment(const StateFingerprint &fingerprint, const RatingAdjustment &adjustment) {
+        const auto index = findOrInsert(fingerprint);
+        _ratingCounts[index] += 1;
+        if (adjustment.draws() > 0.0) {
+            _drawCounts[index] += 1;
+        }
+        for (std::size_t i = 0; i < Player::count; ++i) {
+            const auto &rating = adjustment.rating(i);
+            if (rating.win() > 0.0) {
+                _winCounts[index][i] += 1;
+            }
+            addCombined(index, i, rating.combined());
+        }
+    }
+
+    /// Merge the counters of a record into the record of a state.
+    ///
+    void addRecord(const StateFingerprint &fingerprint, const StateRatingRecord &record) {
+        const auto index = findOrInsert(fingerprint);
+        _ratingCounts[index] += record.ratingCount;
+        _drawCounts[index] += record.drawCount;
+        for (std::size_t i = 0; i < Player::count; ++i) {
+            _winCounts[index][i] += record.winCounts[i];
+            addCombined(index, i, record.combined[i]);
+        }
+    }
+
+    /// Remove all records, but keep the allocated memory.
+    ///
+    void clear() noexcept {
+        _fingerprints.clear();
+        _ratingCounts.clear();
+        _drawCounts.clear();
+        _winCounts.clear();
+        _combined.clear();
+        _compactCombined.clear();
+        std::ranges::fill(_slots, emptySlot);
+    }
+
+private:
+    /// The value of an empty slot.
+    constexpr static Index emptySlot = StateRatingView::emptySlot;
+
+    [[nodiscard]] auto isCompact() const noexcept -> bool { return _precision == RatingPrecision::Float; }
+
+    void addCombined(const Index index, const std::size_t player, const double value) noexcept {
+        if (isCompact()) {
+            _compactCombined[index][player] += static_cast<float>(value);
+        } else {
+            _combined[index][player] += value;
+        }
+    }
+
+    /// The number of slots for a number of records, at a load of 3/4.
+    ///
+    [[nodiscard]] constexpr static auto slotCountFor(const std::size_t recordCount) noexcept -> std::size_t {
+        return recordCount * 4 / 3 + 1;
+    }
+
+    auto findOrInsert(const StateFingerprint &fingerprint) -> Index {
+        if (size() == _fingerprints.capacity() or _slots.empty()) {
+            reserve(std::max(size() + size() / 2, initialCapacity));
+        }
+        auto slot = StateRatingView::homeSlot(fingerprint, _slots.size());
+        for (; _slots[slot] != emptySlot; slot = StateRatingView::nextSlot(slot, _slots.size())) {
+            if (_fingerprints[_slots[slot]] == fingerprint) {
+                return _slots[slot];
+            }
+        }
+        if (size() >= emptySlot) {
+            throw Error("StateRatingTable: Too many records.");
+        }
+        const auto index = static_cast<Index>(size());
+        _fingerprints.emplace_back(fingerprint);
+        _ratingCounts.emplace_back(0);
+        _drawCounts.emplace_back(0);
+        _winCounts.emplace_back();
+        if (isCompact()) {
+            _compactCombined.emplace_back();
+        } else {
+            _combined.emplace_back();
+        }
+        _slots[slot] = index;
+        return index;
+    }
+
+    void rebuildSlots(const std::size_t slotCount) {
+        _slots.assign(slotCount, emptySlot);
+        for (std::size_t index = 0; index < _fingerprints.size(); ++index) {
+            auto slot = StateRatingView::homeSlot(_fingerprints[index], slotCount);
+            while (_slots[slot] != emptySlot) {
+                slot = StateRatingView::nextSlot(slot, slotCount);
+            }
+            _slots[slot] = static_cast<Index>(index);
+        }
+    }
+
+private:
+    RatingPrecision _precision{RatingPrecision::Double}; ///< The precision of the combined ratings.
+    std::vector<StateFingerprint> _fingerprints; ///< The fingerprint of each record.
+    std::vector<uint32_t> _ratingCounts; ///< The number of ratings of each record.
+    std::vector<uint32_t> _drawCounts; ///< The number of draws of each record.
+    std::vector<Counters> _winCounts; ///< The number of wins per player of each record.
+    std::vector<Combined> _combined; ///< The combined rating per player of each record.
+    std::vector<CompactCombined> _compactCombined; ///< The combined rating as 32-bit floats, if used.
+    std::vector<Index> _slots; ///< The record index for each slot, sized for the capacity of the records.
+};
+
@@ -0,0 +1,221 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Player.hpp"
+#include "RatingAdjustment.hpp"
+#include "RatingGame.hpp"
+#include "StateFingerprint.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+
+/// The storage of the combined ratings in a rating table.
+///
+enum class RatingPrecision : uint8_t {
+    Double, ///< 64-bit floats, the default.
+    Float, ///< 32-bit floats, that save 16 bytes per record, but lose small adjustments of large sums.
+};
+
+
+/// The accumulated counters of one state, as stored in a rating table.
+///
+struct StateRatingRecord {
+    using Counters = std::array<uint32_t, Player::count>;
+    using Combined = std::array<double, Player::count>;
+    using CompactCombined = std::array<float, Player::count>;
+
+    uint32_t ratingCount{0}; ///< The number of ratings.
+    uint32_t drawCount{0}; ///< The number of draws.
+    Counters winCounts{}; ///< The number of wins per player.
+    Combined combined{}; ///< The combined rating per player.
+
+    /// Merge the counters of another record of the same state.
+    ///
+    auto operator+=(const StateRatingRecord &other) noexcept -> StateRatingRecord& {
+        ratingCount += other.ratingCount;
+        drawCount += other.drawCount;
+        for (std::size_t i = 0; i < Player::count; ++i) {
+            winCounts[i] += other.winCounts[i];
+            combined[i] += other.combined[i];
+        }
+        return *this;
+    }
+
+    /// Convert the counters into a full rating.
+    ///
+    /// The losses are the ratings that were neither a draw nor a win.
+    ///
+    [[nodiscard]] auto toRating() const noexcept -> RatingGame {
+        Rating::RatingPerPlayer ratings{};
+        for (std::size_t i = 0; i < Player::count; ++i) {
+            const auto lossCount = ratingCount - drawCount - winCounts[i];
+            ratings[i] = RatingPlayer{
+                combined[i],
+                static_cast<double>(winCounts[i]) * RatingAdjustment::deltaForWin,
+                static_cast<double>(lossCount) * RatingAdjustment::deltaForLoss};
+        }
+        return RatingGame{ratingCount, Rating{static_cast<double>(drawCount) * RatingAdjustment::drawsForDraw, ratings}};
+    }
+};
+
+
+/// A read-only view of the arrays of a rating table.
+///
+/// The view does not own the arrays. It either points into a `StateRatingTable`, or into a memory mapped
+/// snapshot, that stores the arrays in the same layout.
+/// @see StateRatingTable
+/// @see StateRatingSnapshot
+///
+class StateRatingView {
+public:
+    using Index = uint32_t;
+    using Counters = StateRatingRecord::Counters;
+    using Combined = StateRatingRecord::Combined;
+    using CompactCombined = StateRatingRecord::CompactCombined;
+
+    /// The value of an empty slot.
+    constexpr static Index emptySlot = std::numeric_limits<Index>::max();
+
+public:
+    /// Create an empty view.
+    ///
+    StateRatingView() = default;
+
+    /// Create a view of the given arrays.
+    ///
+    /// @param recordCount The number of records in the record arrays.
+    /// @param combined The combined ratings, or `nullptr` if they are stored as `compactCombined`.
+    /// @param compactCombined The combined ratings as 32-bit floats, or `nullptr` if they are stored as `combined`.
+    /// @param slotCount The number of slots, zero or larger than the number of records.
+    ///
+    StateRatingView(
+        const std::size_t recordCount,
+        const StateFingerprint *fingerprints,
+        const uint32_t *ratingCounts,
+        const uint32_t *drawCounts,
+        const Counters *winCounts,
+        const Combined *combined,
+        const CompactCombined *compactCombined,
+        const std::size_t slotCount,
+        const Index *slots) noexcept
+    :
+        _recordCount{recordCount},
+        _fingerprints{fingerprints},
+        _ratingCounts{ratingCounts},
+        _drawCounts{drawCounts},
+        _winCounts{winCounts},
+        _combined{combined},
+        _compactCombined{compactCombined},
+        _slotCount{slotCount},
+        _slots{slots} {
+    }
+
+public: // slots
+    /// The first slot to probe for a fingerprint.
+    ///
+    /// The low part of the fingerprint is mapped onto the slots by a multiplication instead of a mask, so
+    /// the number of slots does not have to be a power of two. The low part is independent of the Zobrist
+    /// key, that is used to select the shard of a state.
+    ///
+    /// @param slotCount The number of slots, larger than zero.
+    ///
+    [[nodiscard]] static auto homeSlot(const StateFingerprint &fingerprint, const std::size_t slotCount) noexcept -> std::size_t {
+        return static_cast<std::size_t>((static_cast<unsigned __int128>(fingerprint.low) * slotCount) >> 64U);
+    }
+
+    /// The slot after the given one, wrapping at the end of the slots.
+    ///
+    [[nodiscard]] static auto nextSlot(const std::size_t slot, const std::size_t slotCount) noexcept -> std::size_t {
+        return (slot + 1 == slotCount) ? 0 : slot + 1;
+    }
+
+public: // accessors
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _recordCount; }
+    [[nodiscard]] auto empty() const noexcept -> bool { return _recordCount == 0; }
+    [[nodiscard]] auto slotCount() const noexcept -> std::size_t { return _slotCount; }
+
+    /// Find the record of a state.
+    ///
+    /// The slots of a snapshot are not validated when it is opened. Therefore, the probe is limited to the
+    /// number of slots, and record indexes out of range end it, so damaged slots can not hang a lookup.
+    ///
+    /// @return The index of the record, or `emptySlot` if the state has no record.
+    ///
+    [[nodiscard]] auto find(const StateFingerprint &fingerprint) const noexcept -> Index {
+        if (_slotCount == 0) {
+            return emptySlot;
+        }
+        auto slot = homeSlot(fingerprint, _slotCount);
+        for (std::size_t step = 0; step < _slotCount; ++step, slot = nextSlot(slot, _slotCount)) {
+            const auto index = _slots[slot];
+            if (index >= _recordCount) {
+                return emptySlot;
+            }
+            if (_fingerprints[index] == fingerprint) {
+                return index;
+            }
+        }
+        return emptySlot;
+    }
+
+    /// Access the fingerprint of a record.
+    ///
+    [[nodiscard]] auto fingerprint(const Index index) const noexcept -> const StateFingerprint& {
+        return _fingerprints[index];
+    }
+
+    /// Access the counters of a record.
+    ///
+    [[nodiscard]] auto record(const Index index) const noexcept -> StateRatingRecord {
+        StateRatingRecord result{_ratingCounts[index], _drawCounts[index], _winCounts[index]};
+        if (_compactCombined != nullptr) {
+            for (std::size_t i = 0; i < Player::count; ++i) {
+                result.combined[i] = static_cast<double>(_compactCombined[index][i]);
+            }
+        } else {
+            result.combined = _combined[index];
+        }
+        return result;
+    }
+
+    /// Get the counters of a state.
+    ///
+    /// @return The counters, or no value if the state has no record.
+    ///
+    [[nodiscard]] auto record(const StateFingerprint &fingerprint) const noexcept -> std::optional<StateRatingRecord> {
+        const auto index = find(fingerprint);
+        if (index == emptySlot) {
+            return std::nullopt;
+        }
+        return record(index);
+    }
+
+    /// Get the accumulated rating of a state.
+    ///
+    /// @return The rating, or no value if the state has no rating.
+    ///
+    [[nodiscard]] auto rating(const StateFingerprint &fingerprint) const noexcept -> std::optional<RatingGame> {
+        const auto index = find(fingerprint);
+        if (index == emptySlot) {
+            return std::nullopt;
+        }
+        return record(index).toRating();
+    }
+
+private:
+    std::size_t _recordCount{0}; ///< The number of records.
+    const StateFingerprint *_fingerprints{nullptr}; ///< The fingerprint of each record.
+    const uint32_t *_ratingCounts{nullptr}; ///< The number of ratings of each record.
+    const uint32_t *_drawCounts{nullptr}; ///< The number of draws of each record.
+    const Counters *_winCounts{nullptr}; ///< The number of wins per player of each record.
+    const Combined *_combined{nullptr}; ///< The combined rating per player of each record.
+    const CompactCombined *_compactCombined{nullptr}; ///< The combined rating as 32-bit floats, if used.
+    std::size_t _slotCount{0}; ///< The number of slots.
+    const Index *_slots{nullptr}; ///< The record index for each slot.
+};
+
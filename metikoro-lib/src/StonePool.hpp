@@ -3,7 +3,9 @@
 #pragma once
 
 
+#include "FixedList.hpp"
 #include "Stone.hpp"
+#include "Zobrist.hpp"
 
 #include <algorithm>
 #include <array>
@@ -21,6 +23,9 @@ class StonePool {
 public:
     static constexpr uint8_t capacity = N;
     using Stones = std::array<Stone, N>;
+    using UniqueStones = FixedList<Stone, N>;
+    using UniqueStonePairs = FixedList<StonePair, static_cast<std::size_t>(N) * (N - 1)>;
+    using UniqueStoneQuads = FixedList<StoneQuad, static_cast<std::size_t>(N) * (N - 1) * (N - 2) * (N - 3)>;
 
 public:
     StonePool() = default;
@@ -31,6 +36,10 @@ public:
 
 public:
     [[nodiscard]] auto stones() const noexcept -> const Stones& { return _stones; }
+
+    /// The Zobrist key of the stones in this pool.
+    ///
+    [[nodiscard]] auto zobristKey() const noexcept -> zobrist::Key { return _key; }
     [[nodiscard]] auto at(uint8_t index) const noexcept -> Stone {
         return _stones.at(index);
     }
@@ -73,6 +82,7 @@ public:
         if (stone == Stone::Empty) {
             throw Error("Tried to add an empty stone to the pool.");
         }
+        _key ^= zobrist::poolStoneKey(stone, static_cast<std::size_t>(std::ranges::count(_stones, stone)));
         if (empty()) {
             _stones.front() = stone;
             return;
@@ -95,14 +105,14 @@ public:
             std::copy(it + 1, _stones.end(), it);
         }
         _stones.back() = Stone::Empty;
+        _key ^= zobrist::poolStoneKey(stone, static_cast<std::size_t>(std::ranges::count(_stones, stone)));
     }
 
-    [[nodiscard]] auto uniqueStones() const noexcept -> StoneList {
+    [[nodiscard]] auto uniqueStones() const noexcept -> UniqueStones {
         if (empty()) {
             return {};
         }
-        StoneList result;
-        result.reserve(N);
+        UniqueStones result;
         for (const auto stone : _stones) {
             if (stone == Stone::Empty) {
                 break;
@@ -114,11 +124,11 @@ public:
         return result;
     }
 
-    [[nodiscard]] auto uniqueStonePairs() const noexcept -> std::vector<std::pair<Stone, Stone>> {
+    [[nodiscard]] auto uniqueStonePairs() const noexcept -> UniqueStonePairs {
         if (stoneCount() < 2) {
             return {};
         }
-        std::vector<std::pair<Stone, Stone>> result;
+        UniqueStonePairs result;
         for (auto it = _stones.begin(); it != _stones.end() && *it != Stone::Empty; ++it) {
             for (auto jt = _stones.begin(); jt != _stones.end() && *jt != Stone::Empty; ++jt) {
                 if (it == jt) { continue; }
@@ -130,12 +140,12 @@ public:
         return result;
     }
 
-    [[nodiscard]] auto uniqueStoneQuads() const noexcept -> StoneQuadList {
+    [[nodiscard]] auto uniqueStoneQuads() const noexcept -> UniqueStoneQuads {
         const auto stoneCount = this->stoneCount();
         if (stoneCount < 4) {
             return {};
         }
-        StoneQuadList result;
+        UniqueStoneQuads result;
         for (auto a = 0; a < stoneCount; ++a) {
             for (auto b = 0; b < stoneCount; ++b) {
                 if (a == b) { continue; }
@@ -177,18 +187,60 @@ public: // serialization
         for (auto i = 0; i < N; ++i) {
             result._stones.at(i) = Stone::fromData(data.substr(i * Stone::dataSize(), Stone::dataSize()));
         }
+        result.updateKey();
         return result;
     }
 
+public: // binary serialization
+    /// Add the pool in its binary form, with four bits per slot.
+    ///
+    void addToBinary(std::string &data) const noexcept {
+        for (std::size_t i = 0; i < N; i += 2) {
+            const auto high = (i + 1 < N) ? static_cast<uint8_t>(_stones[i + 1]) : uint8_t{0};
+            data += static_cast<char>(static_cast<uint8_t>(_stones[i]) | static_cast<uint8_t>(high << 4U));
+        }
+    }
+
+    [[nodiscard]] static auto fromBinary(BinaryReader &reader) -> StonePool {
+        StonePool result;
+        for (std::size_t i = 0; i < N; i += 2) {
+            const auto value = reader.readByte();
+            result._stones[i] = stoneFromBinary(value & 0x0fU);
+            if (i + 1 < N) {
+                result._stones[i + 1] = stoneFromBinary(value >> 4U);
+            }
+        }
+        result.updateKey();
+        return result;
+    }
+
+protected:
+    [[nodiscard]] static auto stoneFromBinary(const uint8_t value) -> Stone {
+        if (value >= Stone::count) {
+            throw Error("StonePool: Invalid stone in binary data.");
+        }
+        return Stone{value};
+    }
+
+    void updateKey() noexcept {
+        _key = 0;
+        for (std::size_t i = 0; i < N and _stones[i] != Stone::Empty; ++i) {
+            // The pool is sorted, so equal stones are next to each other.
+            const auto copyIndex = static_cast<std::size_t>(std::ranges::count(_stones.begin(), _stones.begin() + i, _stones[i]));
+            _key ^= zobrist::poolStoneKey(_stones[i], copyIndex);
+        }
+    }
+
 protected:
     Stones _stones;
+    zobrist::Key _key{}; ///< Derived from `_stones`.
 };
 
 
 template<uint8_t N>
 struct std::hash<StonePool<N>> {
     auto operator()(const StonePool<N> &stonePool) const noexcept -> std::size_t {
-        return utility::hashFromArray(stonePool.stones());
+        return stonePool.zobristKey();
     }
 };
 
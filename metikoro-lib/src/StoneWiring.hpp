@@ -19,46 +19,47 @@ public:
 
 public:
     StoneWiring() = default;
-    explicit StoneWiring(const StoneElement element) noexcept {
+    explicit constexpr StoneWiring(const StoneElement element) noexcept {
         const auto [source, target] = element.connection();
         connections[source.value()] = target;
         connections[target.value()] |= source;
         updateUniqueOrientations();
     }
-    auto operator|=(const StoneElement element) noexcept -> StoneWiring& {
+    constexpr auto operator|=(const StoneElement element) noexcept -> StoneWiring& {
         const auto [source, target] = element.connection();
         connections[source.value()] |= target;
         connections[target.value()] |= source;
         updateUniqueOrientations();
         return *this;
     }
-    auto operator|(const StoneElement element) const noexcept -> StoneWiring {
+    constexpr auto operator|(const StoneElement element) const noexcept -> StoneWiring {
         StoneWiring result = *this;
         result |= element;
         return result;
     }
 
-    [[nodiscard]] auto hasStop() const noexcept -> bool {
+    [[nodiscard]] constexpr auto hasStop() const noexcept -> bool {
         return not connections[Anchor::Stop].empty();
     }
 
-    [[nodiscard]] auto isEqual(const Orientation orientationA, const Orientation orientationB) const noexcept -> bool {
+    [[nodiscard]] constexpr auto isEqual(const Orientation orientationA, const Orientation orientationB) const noexcept -> bool {
         return rotatedConnections(orientationA.toRotation()) == rotatedConnections(orientationB.toRotation());
     }
 
 private:
-    [[nodiscard]] auto rotatedConnections(const Rotation rotation) const noexcept -> Connections {
+    [[nodiscard]] constexpr auto rotatedConnections(const Rotation rotation) const noexcept -> Connections {
         if (rotation == Rotation::None) {
             return connections;
         }
         Connections result{};
-        for (const auto cp : Anchor::all()) {
+        for (uint8_t i = 0; i < Anchor::count; ++i) {
+            const auto cp = Anchor{static_cast<Anchor::Value>(i)};
             result[cp.rotated(rotation).value()] = connections[cp.value()].rotated(rotation);
         }
         return result;
     }
 
-    void updateUniqueOrientations() {
+    constexpr void updateUniqueOrientations() {
         uniqueOrientations = Orientation{Orientation::North};
         if (not isEqual(Orientation::North, Orientation::East)) {
             uniqueOrientations |= Orientation{Orientation::East};
@@ -77,7 +78,7 @@ public:
 };
 
 
-inline auto operator|(const StoneElement &lhs, const StoneElement &rhs) noexcept -> StoneWiring {
+constexpr auto operator|(const StoneElement &lhs, const StoneElement &rhs) noexcept -> StoneWiring {
     return StoneWiring{rhs} | lhs;
 }
 
@@ -0,0 +1,264 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+/// A fixed pool of worker threads that execute tasks, with work stealing.
+///
+/// Each worker has its own deque of tasks. Tasks submitted from a worker are added to its own deque, and the
+/// worker takes the most recent task first. An idle worker steals the oldest task from the other workers.
+/// Tasks submitted from other threads are distributed over the workers round-robin.
+///
+/// Tasks must not throw exceptions. Tasks that are still queued when the scheduler is destroyed are
+/// discarded, so call `waitForIdle()` first.
+///
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    /// The worker index of threads that are not workers of a scheduler.
+    constexpr static auto noWorker = std::numeric_limits<std::size_t>::max();
+
+public:
+    /// Create a new scheduler and start its workers.
+    ///
+    /// @param workerCount The number of worker threads, at least one.
+    ///
+    explicit TaskScheduler(const std::size_t workerCount) {
+        const auto count = std::max(workerCount, std::size_t{1});
+        _workers.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            _workers.push_back(std::make_unique<Worker>());
+        }
+        _threads.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            _threads.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    /// Stop all workers, after their current task.
+    ///
+    ~TaskScheduler() {
+        {
+            std::unique_lock const lock{_wakeMutex};
+            _stopping = true;
+        }
+        _wakeCondition.notify_all();
+        _threads.clear(); // join all threads.
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    auto operator=(const TaskScheduler&) -> TaskScheduler& = delete;
+
+public:
+    [[nodiscard]] auto workerCount() const noexcept -> std::size_t { return _workers.size(); }
+
+    /// The number of tasks that were submitted, but did not finish yet.
+    ///
+    [[nodiscard]] auto pendingCount() const noexcept -> std::size_t { return _pendingCount; }
+
+    /// Submit a new task.
+    ///
+    void submit(Task task) {
+        _pendingCount += 1;
+        const auto index = (_currentScheduler == this)
+            ? _currentWorkerIndex
+            : _nextWorker.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+        {
+            auto &worker = *_workers[index];
+            std::unique_lock const lock{worker.mutex};
+            worker.tasks.push_back(std::move(task));
+            // Count the task while holding the lock, so it can not be taken and uncounted before.
+            _queuedCount += 1;
+        }
+        {
+            std::unique_lock const lock{_wakeMutex};
+        }
+        _wakeCondition.notify_one();
+    }
+
+    /// Execute one queued task in the calling thread.
+    ///
+    /// Used by threads that wait for other tasks, so they help instead of blocking a worker.
+    ///
+    /// @return `true` if a task was executed, `false` if there was no queued task.
+    ///
+    auto runPendingTask() noexcept -> bool {
+        const auto index = (_currentScheduler == this) ? _currentWorkerIndex : noWorker;
+        auto task = takeTask(index);
+        if (not task.has_value()) {
+            return false;
+        }
+        runTask(*task);
+        return true;
+    }
+
+    /// Wait until all submitted tasks are finished.
+    ///
+    void waitForIdle() {
+        std::unique_lock lock{_wakeMutex};
+        _idleCondition.wait(lock, [this]() { return _pendingCount == 0; });
+    }
+
+    /// Wait until all submitted tasks are finished, or the timeout expired.
+    ///
+    /// @return `true` if all tasks are finished.
+    ///
+    template<typename Rep, typename Period>
+    auto waitForIdle(const std::chrono::duration<Rep, Period> timeout) -> bool {
+        std::unique_lock lock{_wakeMutex};
+        return _idleCondition.wait_for(lock, timeout, [this]() { return _pendingCount == 0; });
+    }
+
+    /// The scheduler of the calling worker thread, or `nullptr` if the thread is no worker.
+    ///
+    /// Agents use this to run sub-tasks on the scheduler that runs their game.
+    ///
+    [[nodiscard]] static auto current() noexcept -> TaskScheduler* { return _currentScheduler; }
+
+    /// The index of the calling worker thread, or `noWorker`.
+    ///
+    [[nodiscard]] static auto currentWorkerIndex() noexcept -> std::size_t { return _currentWorkerIndex; }
+
+private:
+    /// The task queue of one worker.
+    ///
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(const std::size_t index) noexcept {
+        _currentScheduler = this;
+        _currentWorkerIndex = index;
+        while (true) {
+            if (auto task = takeTask(index); task.has_value()) {
+                runTask(*task);
+                continue;
+            }
+            std::unique_lock lock{_wakeMutex};
+            _wakeCondition.wait(lock, [this]() { return _stopping or _queuedCount > 0; });
+            if (_stopping) {
+                break;
+            }
+        }
+        _currentScheduler = nullptr;
+        _currentWorkerIndex = noWorker;
+    }
+
+    /// Take a task from the own deque, or steal one from another worker.
+    ///
+    /// @param index The index of the calling worker, or `noWorker`.
+    ///
+    auto takeTask(const std::size_t index) noexcept -> std::optional<Task> {
+        if (_queuedCount == 0) {
+            return std::nullopt;
+        }
+        if (index != noWorker) {
+            auto &worker = *_workers[index];
+            std::unique_lock const lock{worker.mutex};
+            if (not worker.tasks.empty()) {
+                auto task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+                _queuedCount -= 1;
+                return task;
+            }
+        }
+        const auto start = (index != noWorker) ? index + 1 : _nextWorker.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < _workers.size(); ++i) {
+            auto &worker = *_workers[(start + i) % _workers.size()];
+            std::unique_lock const lock{worker.mutex};
+            if (not worker.tasks.empty()) {
+                auto task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+                _queuedCount -= 1;
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void runTask(Task &task) noexcept {
+        task();
+        if (--_pendingCount == 0) {
+            std::unique_lock const lock{_wakeMutex};
+            _idleCondition.notify_all();
+        }
+    }
+
+private:
+    static inline thread_local TaskScheduler *_currentScheduler{nullptr};
+    static inline thread_local std::size_t _currentWorkerIndex{noWorker};
+
+    std::vector<std::unique_ptr<Worker>> _workers; ///< The task queues of all workers.
+    std::vector<std::jthread> _threads; ///< The worker threads.
+    std::mutex _wakeMutex; ///< Protects the stop flag, for the conditions.
+    std::condition_variable _wakeCondition; ///< Signals new tasks or the stop to idle workers.
+    std::condition_variable _idleCondition; ///< Signals that all tasks are finished.
+    std::atomic_size_t _pendingCount{0}; ///< The number of submitted tasks, that did not finish.
+    std::atomic_size_t _queuedCount{0}; ///< The number of tasks in all queues.
+    std::atomic_size_t _nextWorker{0}; ///< The next worker for tasks from other threads.
+    bool _stopping{false}; ///< If the workers shall stop.
+};
+
+
+/// A group of sub-tasks, that can be waited for.
+///
+/// While waiting, the calling thread executes other queued tasks of the scheduler, so tasks that split their
+/// work into sub-tasks do not block a worker and do not oversubscribe the machine. This may also execute
+/// unrelated tasks, so the wait can take longer than the sub-tasks themselves.
+///
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler &scheduler) noexcept : _scheduler{scheduler} {}
+
+    /// Wait for all sub-tasks before the group is destroyed.
+    ///
+    ~TaskGroup() {
+        wait();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    auto operator=(const TaskGroup&) -> TaskGroup& = delete;
+
+public:
+    /// Submit a sub-task to this group.
+    ///
+    void run(TaskScheduler::Task task) {
+        _pendingCount += 1;
+        _scheduler.submit([this, task = std::move(task)]() {
+            task();
+            _pendingCount -= 1;
+        });
+    }
+
+    /// Wait for all sub-tasks of this group.
+    ///
+    void wait() noexcept {
+        while (_pendingCount > 0) {
+            if (not _scheduler.runPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    TaskScheduler &_scheduler; ///< The scheduler that executes the sub-tasks.
+    std::atomic_size_t _pendingCount{0}; ///< The number of unfinished sub-tasks.
+};
+
@@ -3,9 +3,14 @@
 #pragma once
 
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <type_traits>
+#include <utility>
 
 
 #define ALL_COMPARE_OPERATORS(Class, Variable) \
@@ -88,6 +93,89 @@ auto hashFromArray(const std::array<T, N> &arr) -> std::size_t {
     return seed;
 }
 
+/// Call a visitor function, and test if the iteration shall continue.
+///
+/// Visitors either return `void` to visit all elements, or `bool`, where `false` stops the iteration.
+///
+/// @return `true` if the iteration shall continue.
+///
+template <typename Fn, typename... Args>
+constexpr auto callVisitor(Fn &fn, Args&&... args) -> bool {
+    if constexpr (std::is_void_v<std::invoke_result_t<Fn&, Args...>>) {
+        fn(std::forward<Args>(args)...);
+        return true;
+    } else {
+        return static_cast<bool>(fn(std::forward<Args>(args)...));
+    }
+}
+
+/// Derive an independent seed from a seed and an index, using the SplitMix64 finalizer.
+///
+/// Used to give every game and every agent its own random stream, that only depends on the seed of the run.
+///
+/// @return The derived seed, never zero.
+///
+[[nodiscard]] constexpr auto deriveSeed(const uint64_t seed, const uint64_t index) noexcept -> uint64_t {
+    auto value = seed + (index + 1U) * 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27U)) * 0x94d049bb133111ebULL;
+    value ^= (value >> 31U);
+    return value != 0 ? value : 1U;
+}
+
+/// A seed sequence of two words, that does not allocate memory.
+///
+/// It generates the same values as a `std::seed_seq` of the two words, which stores its words on the heap.
+///
+class SeedSequence {
+public:
+    using result_type = uint32_t; // NOLINT(*-identifier-naming)
+
+public:
+    constexpr SeedSequence(const uint32_t first, const uint32_t second) noexcept : _words{first, second} {}
+
+public:
+    template<typename Iterator>
+    constexpr void generate(Iterator begin, Iterator end) const noexcept { // NOLINT(*-identifier-naming)
+        const auto n = static_cast<std::size_t>(end - begin);
+        if (n == 0) {
+            return;
+        }
+        const auto at = [&](const std::size_t index) -> auto& { return begin[static_cast<std::ptrdiff_t>(index % n)]; };
+        const auto mixed = [](const uint32_t value) -> uint32_t { return value ^ (value >> 27U); };
+        std::fill(begin, end, 0x8b8b8b8bU);
+        const std::size_t s = _words.size();
+        const std::size_t t = (n >= 623) ? 11 : (n >= 68) ? 7 : (n >= 39) ? 5 : (n >= 7) ? 3 : (n - 1) / 2;
+        const std::size_t p = (n - t) / 2;
+        const std::size_t q = p + t;
+        const std::size_t m = std::max(s + 1, n);
+        for (std::size_t k = 0; k < m; ++k) {
+            const uint32_t r1 = 1664525U * mixed(at(k) ^ at(k + p) ^ at(k + n - 1));
+            uint32_t r2 = r1 + static_cast<uint32_t>(k % n);
+            if (k == 0) {
+                r2 = r1 + static_cast<uint32_t>(s);
+            } else if (k <= s) {
+                r2 += _words[k - 1];
+            }
+            at(k + p) += r1;
+            at(k + q) += r2;
+            at(k) = r2;
+        }
+        for (std::size_t k = m; k < m + n; ++k) {
+            const uint32_t r3 = 1566083941U * mixed(at(k) + at(k + p) + at(k + n - 1));
+            const uint32_t r4 = r3 - static_cast<uint32_t>(k % n);
+            at(k + p) ^= r3;
+            at(k + q) ^= r4;
+            at(k) = r4;
+        }
+    }
+
+    [[nodiscard]] static constexpr auto size() noexcept -> std::size_t { return 2; }
+
+private:
+    std::array<uint32_t, 2> _words;
+};
+
 /// Get the number of characters in the given UTF-8 string.
 ///
 /// @param str The string.
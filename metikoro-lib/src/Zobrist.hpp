@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Field.hpp"
+#include "OrbPosition.hpp"
+#include "Player.hpp"
+#include "Setup.hpp"
+#include "Stone.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+
+/// Zobrist keys for the game state.
+///
+/// Every element of a game state (a field, a stone in a pool, a resource count, an orb) has a pseudo random
+/// 64-bit key. The key of a state is the XOR of the keys of all its elements, so every change of one element
+/// updates the key with two XOR operations. Empty elements have the key zero.
+///
+/// All keys are derived from SplitMix64, so they are identical on every platform and in every run.
+///
+namespace zobrist {
+
+
+using Key = uint64_t;
+
+
+/// The domain of a key, to get independent keys for the different elements of the state.
+///
+enum class Domain : uint8_t {
+    Field = 1,
+    KoLock,
+    PoolStone,
+    ResourceCount,
+    Orb,
+    OrbKo,
+};
+
+
+/// The SplitMix64 finalizer.
+///
+[[nodiscard]] constexpr auto mix(uint64_t value) noexcept -> Key {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27U)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31U);
+}
+
+
+/// Create the key for a value in a domain.
+///
+[[nodiscard]] constexpr auto key(const Domain domain, const uint64_t value) noexcept -> Key {
+    return mix((static_cast<uint64_t>(domain) << 56U) ^ value);
+}
+
+
+/// The number of fields in the board state.
+///
+constexpr std::size_t stateFieldCount = (setup::boardSize - 2U) * (setup::boardSize - 2U);
+
+/// The number of fields on the board, including the frame.
+///
+constexpr std::size_t boardFieldCount = setup::boardSize * setup::boardSize;
+
+
+/// The keys for the stone and orientation of each field in the state.
+///
+inline constexpr auto fieldStoneKeys = [] {
+    std::array<Key, stateFieldCount * Stone::count * Orientation::count> result{};
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        // The first `Orientation::count` keys of each field are for the empty stone.
+        if (i % (Stone::count * Orientation::count) >= Orientation::count) {
+            result[i] = key(Domain::Field, i);
+        }
+    }
+    return result;
+}();
+
+/// The keys for the ko lock of each field in the state.
+///
+inline constexpr auto fieldKoLockKeys = [] {
+    std::array<Key, stateFieldCount * 4U> result{};
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        if (i % 4U != 0) {
+            result[i] = key(Domain::KoLock, i);
+        }
+    }
+    return result;
+}();
+
+/// The keys for an orb on each field of the board.
+///
+inline constexpr auto orbKeys = [] {
+    std::array<Key, boardFieldCount> result{};
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = key(Domain::Orb, i);
+    }
+    return result;
+}();
+
+
+/// Get the key for a field in the board state.
+///
+/// @param index The index of the field in the state grid.
+/// @param field The field.
+///
+[[nodiscard]] inline auto fieldKey(const std::size_t index, const Field field) noexcept -> Key {
+    const auto stoneIndex =
+        (index * Stone::count + static_cast<std::size_t>(field.type())) * Orientation::count
+        + static_cast<std::size_t>(field.orientation().value());
+    return fieldStoneKeys[stoneIndex] ^ fieldKoLockKeys[index * 4U + field.koLock()];
+}
+
+
+/// Get the key for one stone in a stone pool.
+///
+/// A pool holds a multiset of stones, so the n-th copy of the same stone has its own key.
+///
+/// @param stone The stone.
+/// @param copyIndex The zero based index of this copy of the stone in the pool.
+///
+[[nodiscard]] constexpr auto poolStoneKey(const Stone stone, const std::size_t copyIndex) noexcept -> Key {
+    return key(Domain::PoolStone, (static_cast<uint64_t>(stone.type()) << 8U) | copyIndex);
+}
+
+
+/// Combine the key of a stone pool with the player who owns it.
+///
+[[nodiscard]] constexpr auto playerPoolKey(const Key poolKey, const Player player) noexcept -> Key {
+    return std::rotl(poolKey, static_cast<int>(static_cast<uint8_t>(player)) * 16);
+}
+
+
+/// Get the key for the number of stones of one type in the resource pool.
+///
+[[nodiscard]] constexpr auto resourceCountKey(const Stone stone, const uint8_t count) noexcept -> Key {
+    if (count == 0) {
+        return 0;
+    }
+    return key(Domain::ResourceCount, (static_cast<uint64_t>(stone.type()) << 8U) | count);
+}
+
+
+/// Get the key for an orb.
+///
+/// Spare orbs, that are not in the game, have no key.
+///
+[[nodiscard]] inline auto orbKey(const OrbPosition &orbPosition) noexcept -> Key {
+    const auto position = orbPosition.position;
+    if (position.isInvalid()) {
+        return 0;
+    }
+    auto result = orbKeys[position.y() * setup::boardSize + position.x()];
+    if (orbPosition.koLock != 0) {
+        const auto koPosition = orbPosition.koPosition;
+        result ^= key(Domain::OrbKo,
+            (static_cast<uint64_t>(orbPosition.koLock) << 16U)
+            | (static_cast<uint64_t>(koPosition.y()) << 12U) | (static_cast<uint64_t>(koPosition.x()) << 8U)
+            | (static_cast<uint64_t>(position.y()) << 4U) | position.x());
+    }
+    return result;
+}
+
+
+}
+
@@ -0,0 +1,246 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Perft.hpp"
+
+#include "Error.hpp"
+#include "StateCorpus.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+/// Count the moves for a corpus of states, measure the throughput and verify the counts.
+///
+/// Reference files are written with `--write-reference`, a small reference is in the `reference` directory.
+/// @see PerftReference
+///
+class PerftApplication final {
+    constexpr static auto introLine = "MetiKoro Perft - Version 1.0";
+
+public:
+    PerftApplication() = default;
+
+public:
+    auto run(const int argc, const char *argv[]) -> int {
+        try {
+            if (not parseArguments(argc, argv)) {
+                return 0;
+            }
+            loadTasks();
+            countAll();
+            displayReport();
+            if (not _writeReferencePath.empty()) {
+                writeReference();
+            }
+            return checkReference() ? 0 : 1;
+        } catch (const Error &error) {
+            std::cerr << std::format("*** ERROR: {} ***\n\n", error.what());
+            displayHelp();
+            return 1;
+        }
+    }
+
+private:
+    /// One state to count.
+    ///
+    struct Task {
+        GameState state; ///< The state, in the view of the active player.
+        Perft perft; ///< The counter for this state.
+        std::optional<PerftCounts> expected; ///< The counts from a reference file.
+    };
+
+    static void displayHelp() {
+        std::cout << introLine << "\n";
+        std::cout << "Usage: metikoro-perft [<options>]\n\n";
+        std::cout << "Options:\n";
+        std::cout << "  --help, -h                    Display this help message\n";
+        std::cout << "  --corpus=<file>               Load the states from a file, one `toData()` string per line.\n";
+        std::cout << "  --random=<count>              Generate states from random playouts (default: 100 states).\n";
+        std::cout << "  --seed=<number>               The seed for the random playouts (default: 1).\n";
+        std::cout << "  --depth=<depth>               The number of moves to follow (default: 1).\n";
+        std::cout << "  --canonical                   Only count one action sequence for each resulting state.\n";
+        std::cout << "  --threads=<count>, -t=<count> Number of threads to use (default: 1).\n";
+        std::cout << "  --check=<file>                Load the states from a reference file and verify the counts.\n";
+        std::cout << "  --write-reference=<file>      Write the counts into a reference file.\n";
+    }
+
+    auto parseArguments(const int argc, const char *argv[]) -> bool {
+        for (const std::string_view arg : std::span{argv + 1, static_cast<std::size_t>(argc - 1)}) {
+            const auto value = [&arg]() -> std::string {
+                return std::string{arg.substr(arg.find_first_of('=') + 1)};
+            };
+            if (arg == "--help" or arg == "-h") {
+                displayHelp();
+                return false;
+            }
+            if (arg.starts_with("--corpus=")) {
+                _corpusPath = value();
+            } else if (arg.starts_with("--random=")) {
+                _randomCount = std::stoull(value());
+            } else if (arg.starts_with("--seed=")) {
+                _seed = std::stoull(value());
+            } else if (arg.starts_with("--depth=")) {
+                _depth = std::max(std::stoull(value()), 1ULL);
+            } else if (arg == "--canonical") {
+                _mode = ActionSequences::Mode::Canonical;
+            } else if (arg.starts_with("--threads=") or arg.starts_with("-t=")) {
+                _threads = std::clamp(std::stoull(value()), 1ULL, 256ULL);
+            } else if (arg.starts_with("--check=")) {
+                _checkPath = value();
+            } else if (arg.starts_with("--write-reference=")) {
+                _writeReferencePath = value();
+            } else {
+                throw Error{"Unknown option: " + std::string{arg}};
+            }
+        }
+        if (not _corpusPath.empty() and not _checkPath.empty()) {
+            throw Error{"Use either a corpus or a reference file to check."};
+        }
+        return true;
+    }
+
+    void loadTasks() {
+        if (not _checkPath.empty()) {
+            loadReference();
+            return;
+        }
+        StateCorpus corpus;
+        if (not _corpusPath.empty()) {
+            auto input = openInput(_corpusPath);
+            corpus = StateCorpus::fromStream(input);
+        } else {
+            corpus = StateCorpus::fromRandomPlayouts(_randomCount, _seed);
+        }
+        for (const auto &state : corpus) {
+            _tasks.push_back(Task{state, Perft{_depth, _mode}, std::nullopt});
+        }
+    }
+
+    void loadReference() {
+        auto input = openInput(_checkPath);
+        for (const auto &reference : PerftReference::readAll(input)) {
+            _tasks.push_back(Task{reference.state, Perft{reference.depth, reference.mode}, reference.expected});
+        }
+    }
+
+    /// Count all tasks, with the configured number of threads.
+    ///
+    void countAll() {
+        if (_tasks.empty()) {
+            throw Error{"There are no states to count."};
+        }
+        _results.assign(_tasks.size(), PerftCounts{});
+        std::atomic_size_t nextTask{0};
+        auto worker = [&]() {
+            for (auto index = nextTask++; index < _tasks.size(); index = nextTask++) {
+                _results[index] = _tasks[index].perft.count(_tasks[index].state);
+            }
+        };
+        const auto startTime = std::chrono::steady_clock::now();
+        std::vector<std::jthread> threads;
+        threads.reserve(_threads);
+        for (std::size_t i = 0; i < _threads; ++i) {
+            threads.emplace_back(worker);
+        }
+        threads.clear(); // join all threads.
+        _duration = std::chrono::steady_clock::now() - startTime;
+    }
+
+    void displayReport() const {
+        PerftCounts total;
+        for (const auto &result : _results) {
+            total += result;
+        }
+        const auto seconds = std::chrono::duration<double>(_duration).count();
+        const auto perSecond = [seconds](const uint64_t count) -> double {
+            return seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+        };
+        std::cout << introLine << "\n";
+        if (_checkPath.empty()) {
+            std::cout << std::format("> States: {}, depth: {}, mode: {}, threads: {}\n",
+                _tasks.size(), _depth, Perft::modeName(_mode), _threads);
+        } else {
+            std::cout << std::format("> States: {} from {}, threads: {}\n", _tasks.size(), _checkPath, _threads);
+        }
+        std::cout << std::format("  Actions:   {:>16} {:>16.0f} nodes/s\n", total.actions, perSecond(total.actions));
+        std::cout << std::format("  Orb moves: {:>16} {:>16.0f} nodes/s\n", total.orbMoves, perSecond(total.orbMoves));
+        std::cout << std::format("  Moves:     {:>16} {:>16.0f} nodes/s\n", total.moves, perSecond(total.moves));
+        std::cout << std::format("  Total:     {:>16} {:>16.0f} nodes/s\n", total.total(), perSecond(total.total()));
+        std::cout << std::format("  Time:      {:>16.3f} s\n", seconds);
+    }
+
+    void writeReference() const {
+        std::ofstream output{_writeReferencePath};
+        if (not output) {
+            throw Error{"Could not open the reference file for writing: " + _writeReferencePath};
+        }
+        output << "# <state data> <depth> <mode> <actions> <orb moves> <moves>\n";
+        for (std::size_t i = 0; i < _tasks.size(); ++i) {
+            output << PerftReference::toLine(_tasks[i].state, _tasks[i].perft, _results[i]) << "\n";
+        }
+        std::cout << std::format("> Reference written to: {}\n", _writeReferencePath);
+    }
+
+    /// Compare the counts with the reference values.
+    ///
+    /// @return `true` if all counts match, or if there are no reference values.
+    ///
+    [[nodiscard]] auto checkReference() const -> bool {
+        if (_checkPath.empty()) {
+            return true;
+        }
+        std::size_t mismatchCount = 0;
+        for (std::size_t i = 0; i < _tasks.size(); ++i) {
+            const auto &task = _tasks[i];
+            if (task.expected.has_value() and *task.expected != _results[i]) {
+                mismatchCount += 1;
+                std::cout << std::format("*** MISMATCH for state {}: expected {}, counted {}\n  {}\n",
+                    i + 1, task.expected->toString(), _results[i].toString(), task.state.toData());
+            }
+        }
+        if (mismatchCount > 0) {
+            std::cout << std::format("> Reference check FAILED: {} of {} states differ.\n", mismatchCount, _tasks.size());
+            return false;
+        }
+        std::cout << std::format("> Reference check passed: {} states.\n", _tasks.size());
+        return true;
+    }
+
+    [[nodiscard]] static auto openInput(const std::string &path) -> std::ifstream {
+        std::ifstream input{path};
+        if (not input) {
+            throw Error{"Could not open the file: " + path};
+        }
+        return input;
+    }
+
+private:
+    // configuration
+    std::string _corpusPath; ///< The corpus file, or empty for random playouts.
+    std::string _checkPath; ///< The reference file to check, or empty.
+    std::string _writeReferencePath; ///< The reference file to write, or empty.
+    std::size_t _randomCount{100}; ///< The number of states from random playouts.
+    uint64_t _seed{1}; ///< The seed for random playouts.
+    std::size_t _depth{1}; ///< The perft depth.
+    ActionSequences::Mode _mode{ActionSequences::Mode::All}; ///< Which action sequences are counted.
+    std::size_t _threads{1}; ///< The number of threads.
+
+    // working
+    std::vector<Task> _tasks;
+    std::vector<PerftCounts> _results;
+    std::chrono::steady_clock::duration _duration{};
+};
+
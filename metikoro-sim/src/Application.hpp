@@ -4,15 +4,19 @@
 
 
 #include "Configuration.hpp"
-#include "GameSimulator.hpp"
 #include "Console.hpp"
+#include "OrderedGameCommit.hpp"
 #include "RollingAverage.hpp"
+#include "SimulationContext.hpp"
+#include "SimulationStats.hpp"
+#include "TaskScheduler.hpp"
 
 #include <atomic>
 #include <complex>
 #include <csignal>
 #include <future>
 #include <memory>
+#include <optional>
 #include <vector>
 
 
@@ -73,62 +77,80 @@ public:
         _configuration.backend()->load();
     }
 
+    /// Start the workers and schedule the first game of each game chain.
+    ///
+    /// There is one game chain for each configured thread. Each chain owns a simulation context, with a copy
+    /// of the agents and the buffers that are reused for all its games, and schedules its next game as a new
+    /// task, when a game ends. The scheduler balances the chains over its
+    /// workers, and leaves room for agents that split their move evaluation into sub-tasks.
+    ///
     void startSimulationThreads() {
         writeStatus("Starting simulation...", Color::Yellow);
-        _simulationRunning = std::make_unique<std::atomic_bool[]>(_configuration.threads());
-        _simulationFutures.reserve(_configuration.threads());
-        for (std::size_t i = 0; i < _configuration.threads(); ++i) {
-            _simulationRunning[i] = false;
-            _simulationFutures.push_back(std::async(
-                &Application::simulationThread, this, i, &_simulationRunning[i]));
-        }
-        writeWaitingStatus("Waiting for the simulation threads to start", Color::Yellow);
-        while (not (isSimulationStopped() or allSimulationsStarted())) {
-            writeWaitingStatus("Waiting for the simulation threads to start", Color::Yellow);
-            std::this_thread::sleep_for(_configuration.statusUpdateInterval());
+        _chainContexts.reserve(_configuration.threads());
+        for (std::size_t chain = 0; chain < _configuration.threads(); ++chain) {
+            auto &context = _chainContexts.emplace_back(std::make_unique<SimulationContext>(_configuration.agents()));
+            context->simulator().setVerifyRepetitions(_configuration.verifyRepetitions());
         }
-        writeStatus("Simulation started.", Color::Green);
-    }
-
-    [[nodiscard]] auto allSimulationsStarted() const noexcept -> bool {
-        for (std::size_t i = 0; i < _configuration.threads(); ++i) {
-            if (not _simulationRunning[i]) {
-                return false;
-            }
+        _scheduler = std::make_unique<TaskScheduler>(_configuration.threads());
+        _statBlocks = std::make_unique<SimulationStatBlocks>(_scheduler->workerCount());
+        if (_configuration.isReproducible()) {
+            _orderedCommit = std::make_unique<OrderedGameCommit>(_configuration.backend());
+        }
+        for (std::size_t chain = 0; chain < _chainContexts.size(); ++chain) {
+            scheduleGame(chain);
         }
-        return true;
+        writeStatus(std::format("Simulation started with {} workers.", _scheduler->workerCount()), Color::Green);
     }
 
-    void simulationThread(const std::size_t threadId, std::atomic_bool *runningFlag) {
-        assert(runningFlag != nullptr);
-        writeStatus(std::format("Simulation thread {}: started.", threadId), Color::LightBlue);
-        PlayerAgents agents{};
-        const auto &configuredAgents = _configuration.agents();
-        for (std::size_t i = 0; i < configuredAgents.size(); ++i) {
-            agents[i] = configuredAgents[i]->copyForThread();
-        }
-        *runningFlag = true;
-        while (not isSimulationStopped()) {
-            simulateGame(agents);
+    /// Schedule the next game of a game chain.
+    ///
+    /// Each game is claimed before it is scheduled, so no more than the configured maximum of games is
+    /// simulated.
+    ///
+    void scheduleGame(const std::size_t chain) {
+        if (isSimulationStopped()) {
+            return;
         }
-        writeStatus(std::format("Simulation thread {}: shutting down agent...", threadId), Color::LightBlue);
-        for (const auto &agent : agents) {
-            agent->shutdown();
+        const auto gameIndex = claimGame();
+        if (not gameIndex.has_value()) {
+            return;
         }
-        writeStatus(std::format("Simulation thread {}: stopped.", threadId), Color::LightBlue);
+        _scheduler->submit([this, chain, gameIndex = *gameIndex]() {
+            simulateGame(*_chainContexts[chain], gameIndex);
+            scheduleGame(chain);
+        });
     }
 
-    void simulateGame(const PlayerAgents &agents) noexcept {
-        for (const auto &agent : agents) {
-            agent->gameStart();
+    /// Claim the next game.
+    ///
+    /// @return The index of the claimed game, or no value if the maximum of games is claimed.
+    ///
+    [[nodiscard]] auto claimGame() noexcept -> std::optional<uint64_t> {
+        const auto maximumGames = _configuration.maximumGames();
+        auto claimedGames = _claimedGames.load();
+        while (maximumGames == 0 or claimedGames < maximumGames) {
+            if (_claimedGames.compare_exchange_weak(claimedGames, claimedGames + 1)) {
+                return claimedGames;
+            }
         }
-        auto gameSimulator = GameSimulator(agents);
-        gameSimulator.run();
-        for (const auto &agent : agents) {
-            agent->gameEnd(gameSimulator.gameLog());
+        return std::nullopt;
+    }
+
+    /// Simulate one game.
+    ///
+    /// In a reproducible run, the agents get seeds derived from the game index, and the game is committed
+    /// to the backend in the order of the game index.
+    ///
+    void simulateGame(SimulationContext &context, const uint64_t gameIndex) noexcept {
+        const auto gameSeed = _configuration.isReproducible()
+            ? utility::deriveSeed(_configuration.seed(), gameIndex) : uint64_t{0};
+        const auto &gameLog = context.runGame(gameSeed);
+        if (_orderedCommit != nullptr) {
+            _orderedCommit->add(gameIndex, gameLog);
+        } else {
+            _configuration.backend()->addGame(gameLog);
         }
-        _configuration.backend()->addGame(gameSimulator.gameLog());
-        addGameStat(gameSimulator.gameLog());
+        addGameStat(gameLog);
     }
 
     void startSimulationStatusThread() {
@@ -142,6 +164,10 @@ public:
         }
     }
 
+    /// Merge the statistics of all workers and display them.
+    ///
+    /// The rolling averages are only accessed from the status thread.
+    ///
     void displaySimulationStatus() {
         using namespace std::chrono;
         static steady_clock::time_point lastDisplay{};
@@ -149,32 +175,36 @@ public:
         if (isSimulationStopped()) {
             return;
         }
-        std::unique_lock const lock(_statMutex);
+        const auto stats = _statBlocks->merged();
         const auto now = steady_clock::now();
         const auto duration = now - std::exchange(lastDisplay, now);
 
-        const auto gamesInDuration = _simulationRating.ratingCount() - _lastSimulatedGamesCount;
-        _lastSimulatedGamesCount = _simulationRating.ratingCount();
+        const auto gamesInDuration = stats.gameCount() - std::exchange(_lastSimulatedGamesCount, stats.gameCount());
+        const auto movesInDuration = stats.moveCount - std::exchange(_lastSimulatedMovesCount, stats.moveCount);
         const auto gamesPerHour = static_cast<double>(gamesInDuration) /
             static_cast<double>(duration_cast<milliseconds>(duration).count()) * 3'600'000.0;
 
         _gamesPerHour.add(gamesPerHour);
+        if (gamesInDuration > 0) {
+            _moveAverage.add(static_cast<double>(movesInDuration) / static_cast<double>(gamesInDuration));
+        }
         if (_console->colorEnabled()) {
             _console->writeSimulationStatus(
-                _simulationRating,
+                stats.rating,
                 _gamesPerHour.average(),
                 _moveAverage.average(),
                 _configuration.backend()->status());
         } else {
-            writeStatus(std::format("Simulation Running: {}", _simulationRating.toString()), Color::Green);
+            writeStatus(std::format("Simulation Running: {}", stats.rating.toString()), Color::Green);
         }
     }
 
+    /// Add a finished game to the statistics of the calling worker.
+    ///
     void addGameStat(const GameLog &gameLog) {
-        std::unique_lock const lock(_statMutex);
-        _simulationRating.applyAdjustment(RatingAdjustment{gameLog.winningPlayer()});
-        _moveAverage.add(static_cast<double>(gameLog.size()));
-        if (hasMaximumGamesReached()) {
+        _statBlocks->addGame(TaskScheduler::currentWorkerIndex(), gameLog);
+        const auto finishedGames = _finishedGames.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (_configuration.maximumGames() > 0 and finishedGames >= _configuration.maximumGames()) {
             _stopRequested = true; // As soon we reach a configured maximum of games, kindly request a stop.
         }
     }
@@ -183,16 +213,14 @@ public:
         while (not isSimulationStopped()) {
             std::this_thread::sleep_for(std::chrono::milliseconds{100});
         }
-        bool waitingForFuture = true;
-        while (waitingForFuture) {
-            auto waitUntil = std::chrono::steady_clock::now() + _configuration.statusUpdateInterval();
-            waitingForFuture = false;
-            for (const std::future<void> &future : _simulationFutures) {
-                if (future.wait_until(waitUntil) == std::future_status::timeout) {
-                    writeWaitingStatus("Waiting for simulation threads to finish.", Color::Yellow);
-                    waitingForFuture = true;
-                    break;
-                }
+        while (not _scheduler->waitForIdle(_configuration.statusUpdateInterval())) {
+            writeWaitingStatus("Waiting for the running games to finish.", Color::Yellow);
+        }
+        _scheduler.reset();
+        writeWaitingStatus("Shutting down agents...", Color::Yellow);
+        for (const auto &context : _chainContexts) {
+            for (const auto &agent : context->agents()) {
+                agent->shutdown();
             }
         }
     }
@@ -201,14 +229,16 @@ public:
         return _stopRequested;
     }
 
-    [[nodiscard]] auto hasMaximumGamesReached() const noexcept -> bool {
-        return _configuration.maximumGames() > 0 and _simulationRating.ratingCount() >= _configuration.maximumGames();
-    }
-
     void shutdownBackend() {
         writeWaitingStatus("All simulation threads stopped, shutting down backend...", Color::Yellow);
         _configuration.backend()->shutdown();
-        writeLog("Simulation stopped.", Color::Green);
+        const auto stats = _statBlocks->merged();
+        if (stats.gameCount() > 0) {
+            writeLog(std::format("Game length: median {} moves, p90 {} moves, average {:.1f} moves.",
+                stats.lengthPercentile(50), stats.lengthPercentile(90),
+                static_cast<double>(stats.moveCount) / static_cast<double>(stats.gameCount())));
+        }
+        writeLog(std::format("Simulation stopped after {} games.", stats.gameCount()), Color::Green);
     }
 
 private:
@@ -219,11 +249,14 @@ private:
     Configuration _configuration;
 
     std::future<void> _statusUpdateFuture;
-    std::vector<std::future<void>> _simulationFutures;
-    std::unique_ptr<std::atomic_bool[]> _simulationRunning;
-    std::mutex _statMutex;
+    std::unique_ptr<TaskScheduler> _scheduler;
+    std::vector<std::unique_ptr<SimulationContext>> _chainContexts;
+    std::atomic_uint64_t _claimedGames{0};
+    std::atomic_uint64_t _finishedGames{0};
+    std::unique_ptr<SimulationStatBlocks> _statBlocks;
+    std::unique_ptr<OrderedGameCommit> _orderedCommit;
     RollingAverage<double, rollingAverageCount> _gamesPerHour;
     RollingAverage<double, rollingAverageCount> _moveAverage;
     uint64_t _lastSimulatedGamesCount{0};
-    RatingGame _simulationRating;
+    uint64_t _lastSimulatedMovesCount{0};
 };
@@ -39,6 +39,9 @@ public:
         } else {
             writeLog("> Unlimited number of games. Press Ctrl+C to stop the simulation.");
         }
+        if (isReproducible()) {
+            writeLog(std::format("> Reproducible run with seed {}. Games are committed in order.", _seed));
+        }
         writeLog(std::format("> Using backend: {}", _backendName));
         if (_backend != nullptr) {
             _backend->displayConfiguration();
@@ -59,7 +62,10 @@ public:
         writeLog("  --help, -h                         Display this help message");
         writeLog("  --threads=<count>, -t=<count>      Number of threads to use");
         writeLog("  --games=<count>, -g=<count>        The maximum number of games to simulate.");
+        writeLog("  --seed=<number>                    Reproducible run: Derive the seed of each game from this");
+        writeLog("                                     seed and commit the games in order. 0 = disabled.");
         writeLog("  --version, -v                      Display version information");
+        writeLog("  --verify-repetitions               Verify repeated state keys by comparing the full states.");
         writeLog("  --no-color                         Do not use color or ANSI codes for the output.");
         writeLog("  --status-update-interval=<ms>      The interval in milliseconds for the status update.");
         writeLog("  --plain-status                     Display a simple text based status.");
@@ -90,6 +96,10 @@ public:
                 _threads = std::min(std::max(_threads, static_cast<std::size_t>(1)), static_cast<std::size_t>(100));
             } else if (arg.starts_with("--games=") or arg.starts_with("-g=")) {
                 _maximumGames = std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)});
+            } else if (arg.starts_with("--seed=")) {
+                _seed = std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)});
+            } else if (arg == "--verify-repetitions") {
+                _verifyRepetitions = true;
             } else if (arg == "--no-color") {
                 _console->setColorEnabled(false);
             } else if (arg.starts_with("--status-update-interval=")) {
@@ -180,6 +190,9 @@ public: // attributes
     [[nodiscard]] auto agents() const noexcept -> const PlayerAgents& { return _agents; }
     [[nodiscard]] auto threads() const noexcept -> std::size_t { return _threads; }
     [[nodiscard]] auto maximumGames() const noexcept -> std::size_t { return _maximumGames; }
+    [[nodiscard]] auto seed() const noexcept -> uint64_t { return _seed; }
+    [[nodiscard]] auto isReproducible() const noexcept -> bool { return _seed != 0; }
+    [[nodiscard]] auto verifyRepetitions() const noexcept -> bool { return _verifyRepetitions; }
     [[nodiscard]] auto statusUpdateInterval() const noexcept -> std::chrono::milliseconds { return _statusUpdateInterval; }
 
 private:
@@ -194,4 +207,6 @@ private:
     PlayerAgents _agents{};
     std::size_t _threads{16}; ///< The number of thread
     std::size_t _maximumGames{0}; ///< The maximum number of games. 0 = unlimited.
+    uint64_t _seed{0}; ///< The seed for a reproducible run. 0 = not reproducible.
+    bool _verifyRepetitions{false}; ///< If repeated state keys are verified with the full states.
 };
@@ -0,0 +1,59 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "Backend.hpp"
+#include "GameLog.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+
+/// Commits finished games to a backend, in the order of their game index.
+///
+/// Games finish in an order that depends on the thread scheduling. In a reproducible run, games that finish
+/// early wait in this buffer, until all games with a lower index are committed. So the backend receives the
+/// same games in the same order, with any number of threads. Commits are serialized, and the buffer grows
+/// while a long game holds back the games after it.
+///
+class OrderedGameCommit {
+public:
+    explicit OrderedGameCommit(BackendPtr backend) noexcept : _backend{std::move(backend)} {}
+
+public:
+    /// Add a finished game, and commit all games that are ready.
+    ///
+    /// @param gameIndex The index of the game. Each index from zero must be added exactly once.
+    /// @param gameLog The log of the game.
+    ///
+    void add(const uint64_t gameIndex, const GameLog &gameLog) {
+        std::unique_lock const lock{_mutex};
+        if (gameIndex != _nextIndex) {
+            _waitingGames.emplace(gameIndex, gameLog);
+            return;
+        }
+        _backend->addGame(gameLog);
+        _nextIndex += 1;
+        for (auto it = _waitingGames.begin(); it != _waitingGames.end() and it->first == _nextIndex;) {
+            _backend->addGame(it->second);
+            _nextIndex += 1;
+            it = _waitingGames.erase(it);
+        }
+    }
+
+    /// The number of games that wait for a game with a lower index.
+    ///
+    [[nodiscard]] auto waitingCount() const noexcept -> std::size_t {
+        std::unique_lock const lock{_mutex};
+        return _waitingGames.size();
+    }
+
+private:
+    BackendPtr _backend; ///< The backend that receives the games.
+    mutable std::mutex _mutex; ///< Serializes the commits.
+    uint64_t _nextIndex{0}; ///< The index of the next game to commit.
+    std::map<uint64_t, GameLog> _waitingGames; ///< The games that finished before their predecessors.
+};
+
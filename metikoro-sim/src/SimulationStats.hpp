@@ -0,0 +1,113 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+
+#include "GameLog.hpp"
+#include "RatingGame.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+
+/// The statistics of simulated games, that can be merged.
+///
+struct SimulationStats {
+    /// The number of moves per bin of the game lengths.
+    constexpr static std::size_t lengthBinWidth = 4;
+    /// The number of bins for the game lengths. Longer games are counted in the last bin.
+    constexpr static std::size_t lengthBinCount = 512;
+
+    using LengthHistogram = std::array<uint64_t, lengthBinCount>;
+
+    RatingGame rating; ///< The combined rating of all games.
+    uint64_t moveCount{0}; ///< The total number of moves in all games.
+    LengthHistogram lengthHistogram{}; ///< The number of games for each game length, in moves.
+
+    [[nodiscard]] auto gameCount() const noexcept -> uint64_t { return rating.ratingCount(); }
+
+    void addGame(const GameLog &gameLog) {
+        rating.applyAdjustment(RatingAdjustment{gameLog.winningPlayer()});
+        moveCount += gameLog.size();
+        lengthHistogram[std::min(gameLog.size() / lengthBinWidth, lengthBinCount - 1)] += 1;
+    }
+
+    void merge(const SimulationStats &other) noexcept {
+        rating.merge(other.rating);
+        moveCount += other.moveCount;
+        for (std::size_t i = 0; i < lengthBinCount; ++i) {
+            lengthHistogram[i] += other.lengthHistogram[i];
+        }
+    }
+
+    /// Get a percentile of the game lengths, using the nearest-rank method.
+    ///
+    /// @param percent The percentile, from 0 to 100.
+    /// @return The largest game length of the bin, in moves, or zero if there are no games.
+    ///
+    [[nodiscard]] auto lengthPercentile(const double percent) const noexcept -> std::size_t {
+        const auto rank = std::max(
+            static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(gameCount()))), uint64_t{1});
+        uint64_t count = 0;
+        for (std::size_t i = 0; i < lengthBinCount; ++i) {
+            count += lengthHistogram[i];
+            if (count >= rank) {
+                return (i + 1) * lengthBinWidth - 1;
+            }
+        }
+        return 0;
+    }
+};
+
+
+/// One block of statistics for each worker thread.
+///
+/// Each worker only adds games to its own block, so the workers never wait for each other. The lock of a
+/// block is only shared with the status thread, that merges all blocks periodically. The blocks are aligned
+/// to cache lines, so the workers do not invalidate each other's caches.
+///
+class SimulationStatBlocks {
+public:
+    explicit SimulationStatBlocks(const std::size_t count)
+        : _blockCount{std::max(count, std::size_t{1})}, _blocks{std::make_unique<Block[]>(_blockCount)} {
+    }
+
+public:
+    /// Add a finished game to a block.
+    ///
+    /// @param index The index of the calling worker.
+    /// @param gameLog The log of the game.
+    ///
+    void addGame(const std::size_t index, const GameLog &gameLog) {
+        auto &block = _blocks[index % _blockCount];
+        std::unique_lock const lock{block.mutex};
+        block.stats.addGame(gameLog);
+    }
+
+    /// Merge the statistics of all blocks.
+    ///
+    [[nodiscard]] auto merged() const -> SimulationStats {
+        SimulationStats result;
+        for (std::size_t i = 0; i < _blockCount; ++i) {
+            std::unique_lock const lock{_blocks[i].mutex};
+            result.merge(_blocks[i].stats);
+        }
+        return result;
+    }
+
+private:
+    /// The statistics of one worker.
+    ///
+    struct alignas(64) Block {
+        mutable std::mutex mutex;
+        SimulationStats stats;
+    };
+
+    std::size_t _blockCount; ///< The number of blocks.
+    std::unique_ptr<Block[]> _blocks; ///< The blocks.
+};
+
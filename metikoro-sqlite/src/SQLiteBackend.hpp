@@ -8,10 +8,13 @@
 #include "GameLog.hpp"
 #include "GameResult.hpp"
 #include "Player.hpp"
+#include "RatingUpdateBuffer.hpp"
 #include "Error.hpp"
 
 #include "sqlite3.h"
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <filesystem>
 #include <future>
@@ -24,12 +27,15 @@
 namespace fs = std::filesystem;
 
 
+/// A backend that stores the ratings of the states in a SQLite database.
+///
+/// The adjustments of the games are combined in an update buffer, so each distinct state is only written
+/// once per transaction. The buffer is flushed into the update queue when it holds the configured number of
+/// states, after the flush interval, and on shutdown. The memory for the updates is therefore bounded by the
+/// aggregation size times the maximum queue size plus one.
+///
 class SQLiteBackend : public Backend {
-    struct DbUpdate {
-        std::string stateData;
-        RatingAdjustment ratingAdjustment;
-    };
-    using DbUpdateList = std::vector<DbUpdate>;
+    using DbUpdateList = RatingUpdateBuffer::Updates;
     using DbUpdateListPtr = std::shared_ptr<DbUpdateList>;
 
 public:
@@ -41,8 +47,18 @@ public:
         result += "  --page-size=<bytes>               The size for a page.\n";
         result += "  --synchronous-mode=<mode>         The synchronous mode.\n";
         result += "  --maximum-update-queue-size=<n>   The maximum number of update lists in the queue.\n";
+        result += "  --aggregation-size=<states>       Flush the update buffer when it holds this number of\n";
+        result += "                                    distinct states. Default is 20000.\n";
+        result += "  --flush-interval=<ms>             Also flush the update buffer after this time. Default is\n";
+        result += "                                    zero, to only flush by size and on shutdown, as flushes\n";
+        result += "                                    by time make the database depend on the timing of a run.\n";
         result += "  --fast-unsafe                     Set mode to WAL, sync OFF, cache 32k pages.\n";
         result += "  --vacuum                          Execute VACUUM before starting.\n";
+        result += "  --canonical-states                Store all rotations of a state as one canonical state.\n";
+        result += "                                    This merges states that only differ in the player to move.\n";
+        result += "                                    A database can only be used with one state form.\n";
+        result += "  --binary-keys                     Store the states in the compact binary form, as BLOB.\n";
+        result += "                                    A database can only be used with one state encoding.\n";
         return result;
     }
 
@@ -82,12 +98,25 @@ public:
                     throw Error{std::format("Invalid maximum update queue size: {}", newSize)};
                 }
                 _maximumUpdateQueueSize = newSize;
+            } else if (arg.starts_with("--aggregation-size=")) {
+                auto newSize = std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)});
+                if (newSize < 1 or newSize > 10'000'000) {
+                    throw Error{std::format("Invalid aggregation size: {}", newSize)};
+                }
+                _aggregationSize = newSize;
+            } else if (arg.starts_with("--flush-interval=")) {
+                _flushInterval = std::chrono::milliseconds{
+                    std::stoull(std::string{arg.substr(arg.find_first_of('=') + 1)})};
             } else if (arg == "--fast-unsafe") {
                 _cacheSize = 262'144; // ~1GB with 4096 page-size.
                 _journalMode = "WAL";
                 _synchronousMode = "OFF";
             } else if (arg == "--vacuum") {
                 _executeVacuum = true;
+            } else if (arg == "--canonical-states") {
+                _canonicalStates = true;
+            } else if (arg == "--binary-keys") {
+                _binaryKeys = true;
             } else {
                 throw Error{"Unknown sqlite backend option: " + std::string{arg}};
             }
@@ -117,6 +146,12 @@ public:
             writeLog(std::format("  synchronous-mode...........: {}", *_synchronousMode), Color::Default);
         }
         writeLog(std::format("  maximum-update-queue-size..: {}", _maximumUpdateQueueSize), Color::Default);
+        writeLog(std::format("  aggregation-size...........: {}", _aggregationSize), Color::Default);
+        if (_flushInterval.count() > 0) {
+            writeLog(std::format("  flush-interval.............: {}ms", _flushInterval.count()), Color::Default);
+        }
+        writeLog(std::format("  state-form.................: {}", stateForm()), Color::Default);
+        writeLog(std::format("  state-encoding.............: {}", stateEncoding()), Color::Default);
     }
 
     void load() override {
@@ -129,26 +164,91 @@ public:
         }
         auto ratingAdjustment = gameLog.createRatingAdjustments();
         assert(gameLog.size() == ratingAdjustment.size());
-        auto updateList = std::make_shared<DbUpdateList>();
-        updateList->reserve(gameLog.size());
+        // Create the keys without a lock, then merge them into the buffer.
+        std::vector<std::pair<std::string, RatingAdjustment>> updates;
+        updates.reserve(gameLog.size());
         for (const auto &[turn, adjustment] : std::views::zip(gameLog, ratingAdjustment)) {
-            updateList->emplace_back(turn.state.toData(), adjustment);
+            if (_canonicalStates) {
+                auto canonicalAdjustment = adjustment;
+                canonicalAdjustment.rotate(turn.canonicalRotation());
+                updates.emplace_back(stateKey(turn.canonicalState()), canonicalAdjustment);
+            } else {
+                updates.emplace_back(stateKey(turn.playerState()), adjustment);
+            }
+        }
+        std::unique_lock lock(_updateBufferMutex);
+        if (_updateBuffer.empty()) {
+            _updateBufferStart = std::chrono::steady_clock::now();
+        }
+        for (auto &[key, adjustment] : updates) {
+            _updateBuffer.add(std::move(key), adjustment);
+        }
+        _bufferedStateCount = _updateBuffer.size();
+        if (_updateBuffer.size() >= _aggregationSize) {
+            pushUpdateBuffer(lock);
         }
-        push(std::move(updateList));
     }
 
     [[nodiscard]] auto status() const noexcept -> std::string override {
         std::unique_lock const lock(_updateQueueMutex);
-        return std::format("OK: {:> 3}/{:> 3} updates in queue.", _updateQueue.size(), _maximumUpdateQueueSize);
+        return std::format("OK: {:> 3}/{:> 3} updates in queue, {} states buffered.",
+            _updateQueue.size(), _maximumUpdateQueueSize, _bufferedStateCount.load());
     }
 
     void shutdown() override {
+        flushUpdateBuffer();
         waitForQueue();
         _stopRequested = true;
         waitForUpdateThread();
     }
 
 private:
+    /// Push the buffered updates into the update queue.
+    ///
+    void flushUpdateBuffer() {
+        std::unique_lock lock(_updateBufferMutex);
+        if (not _updateBuffer.empty()) {
+            pushUpdateBuffer(lock);
+        }
+    }
+
+    /// Take the buffered updates and push them into the update queue.
+    ///
+    /// The push lock is acquired before the buffer lock is released, so the lists are queued in the order
+    /// they were taken from the buffer. While a push waits for room in the queue, the buffer stays unlocked.
+    ///
+    /// @param bufferLock The held lock of the buffer, it is released by this method.
+    ///
+    void pushUpdateBuffer(std::unique_lock<std::mutex> &bufferLock) {
+        auto updateList = std::make_shared<DbUpdateList>(_updateBuffer.take());
+        _bufferedStateCount = 0;
+        std::unique_lock const pushLock(_updatePushMutex);
+        bufferLock.unlock();
+        push(std::move(updateList));
+    }
+
+    /// Take the buffered updates, if the flush interval passed since the first of them was added.
+    ///
+    /// Called from the update thread, that writes the updates directly. As a simulation thread may hold the
+    /// locks while it waits for room in the queue, the update thread never waits for them. While a list is
+    /// pushed, the buffer is not taken, so it is not written before the older list.
+    ///
+    auto takeExpiredUpdateBuffer() -> DbUpdateListPtr {
+        if (_flushInterval.count() == 0) {
+            return {};
+        }
+        std::unique_lock const lock(_updateBufferMutex, std::try_to_lock);
+        if (not lock.owns_lock() or _updateBuffer.empty() or std::chrono::steady_clock::now() - _updateBufferStart < _flushInterval) {
+            return {};
+        }
+        std::unique_lock const pushLock(_updatePushMutex, std::try_to_lock);
+        if (not pushLock.owns_lock()) {
+            return {};
+        }
+        _bufferedStateCount = 0;
+        return std::make_shared<DbUpdateList>(_updateBuffer.take());
+    }
+
     void waitForQueue() {
         writeLog("SQLite: Shutdown request received, waiting 10s for queue.", Color::Orange);
         const auto deadLine = std::chrono::steady_clock::now() + std::chrono::seconds{10};
@@ -210,11 +310,15 @@ private:
             callVacuum();
         }
         createSchema();
+        verifyMetadata("state_form", stateForm(), "player");
+        verifyMetadata("state_encoding", stateEncoding(), "text");
         _updateStmt = prepareUpdateStmt();
         writeLog("SQLite: Processing database updates.", Color::Green);
         while (not _stopRequested) {
             if (auto dbUpdateList = popUpdateQueue()) {
                 writeUpdateList(dbUpdateList);
+            } else if (auto expiredUpdateList = takeExpiredUpdateBuffer()) {
+                writeUpdateList(expiredUpdateList);
             }
         }
         writeLog("SQLite: Shutting down the update thread.", Color::Orange);
@@ -231,15 +335,20 @@ private:
         try {
             for (const auto &update : *updateList) {
                 auto stmt = _updateStmt.get();
-                const auto &state = update.stateData;
-                const auto &adj = update.ratingAdjustment;
+                const auto &state = update.stateKey;
+                const auto &rating = update.rating;
                 sqlite3_reset(stmt);
-                sqlite3_bind_text(stmt, 1, state.c_str(), state.size(), SQLITE_STATIC);
-                sqlite3_bind_double(stmt, 2, adj.draws());
+                if (_binaryKeys) {
+                    sqlite3_bind_blob(stmt, 1, state.data(), static_cast<int>(state.size()), SQLITE_STATIC);
+                } else {
+                    sqlite3_bind_text(stmt, 1, state.c_str(), static_cast<int>(state.size()), SQLITE_STATIC);
+                }
+                sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(rating.ratingCount()));
+                sqlite3_bind_double(stmt, 3, rating.draws());
                 for (int player = 0; player < 4; ++player) {
-                    sqlite3_bind_double(stmt, 3 + (player * 3), adj.ratings().at(player).combined());
-                    sqlite3_bind_double(stmt, 4 + (player * 3), adj.ratings().at(player).win());
-                    sqlite3_bind_double(stmt, 5 + (player * 3), adj.ratings().at(player).loss());
+                    sqlite3_bind_double(stmt, 4 + (player * 3), rating.ratings().at(player).combined());
+                    sqlite3_bind_double(stmt, 5 + (player * 3), rating.ratings().at(player).win());
+                    sqlite3_bind_double(stmt, 6 + (player * 3), rating.ratings().at(player).loss());
                 }
                 if (sqlite3_step(stmt) != SQLITE_DONE) {
                     throwSqliteError("Failed to execute update statement.");
@@ -329,6 +438,10 @@ private:
                 next_state_id INTEGER NOT NULL
             );
             CREATE UNIQUE INDEX IF NOT EXISTS idx_game_move_id_data ON game_move (state_id, next_move_data);
+            CREATE TABLE IF NOT EXISTS metadata (
+                name TEXT PRIMARY KEY,
+                value TEXT NOT NULL
+            );
         )";
 
         auto result = sqlite3_exec(_db.get(), createSchemaSQL, nullptr, nullptr, nullptr);
@@ -337,6 +450,73 @@ private:
         }
     }
 
+    /// The form of the states stored in the database.
+    ///
+    [[nodiscard]] auto stateForm() const noexcept -> std::string_view {
+        return _canonicalStates ? "canonical" : "player";
+    }
+
+    /// The encoding of the states stored in the database.
+    ///
+    [[nodiscard]] auto stateEncoding() const noexcept -> std::string_view {
+        return _binaryKeys ? "binary" : "text";
+    }
+
+    /// Create the key for a state, in the configured encoding.
+    ///
+    [[nodiscard]] auto stateKey(const GameState &state) const noexcept -> std::string {
+        return _binaryKeys ? state.toBinary() : state.toData();
+    }
+
+    /// Make sure the database stores the states as configured.
+    ///
+    /// If the entry is missing, it is written with the configured value for new databases. Databases with
+    /// states, but without this entry, were created before the entry existed and use the legacy value.
+    ///
+    /// @param name The name of the metadata entry.
+    /// @param configuredValue The configured value.
+    /// @param legacyValue The value for databases created before the entry existed.
+    ///
+    void verifyMetadata(
+        const std::string_view &name,
+        const std::string_view &configuredValue,
+        const std::string_view &legacyValue) {
+
+        auto storedValue = queryText(std::format("SELECT value FROM metadata WHERE name = '{}';", name));
+        if (not storedValue) {
+            const auto hasStates = queryText("SELECT 1 FROM game_state LIMIT 1;").has_value();
+            storedValue = std::string{hasStates ? legacyValue : configuredValue};
+            const auto insertSQL = std::format(
+                "INSERT INTO metadata (name, value) VALUES ('{}', '{}');", name, *storedValue);
+            if (sqlite3_exec(_db.get(), insertSQL.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+                throwSqliteError("Failed to write the metadata.");
+            }
+        }
+        if (*storedValue != configuredValue) {
+            throw Error{std::format(
+                R"(The database uses "{}" for "{}", but "{}" is configured.)",
+                *storedValue, name, configuredValue)};
+        }
+    }
+
+    /// Run a query and return the first column of the first row as text.
+    ///
+    /// @return The text, or no value if the query returned no rows.
+    ///
+    auto queryText(const std::string_view &sql) const -> std::optional<std::string> {
+        sqlite3_stmt *rawStmt;
+        if (sqlite3_prepare_v2(_db.get(), sql.data(), static_cast<int>(sql.size()), &rawStmt, nullptr) != SQLITE_OK) {
+            throwSqliteError("Failed to prepare query.");
+        }
+        const auto stmt = std::shared_ptr<sqlite3_stmt>(rawStmt, [](sqlite3_stmt *stmt) {
+            sqlite3_finalize(stmt);
+        });
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return std::nullopt;
+        }
+        return std::string{reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0))};
+    }
+
     auto prepareUpdateStmt() const -> std::shared_ptr<sqlite3_stmt> {
         sqlite3_stmt *rawStmt;
         const char updateMoveSQL[] = R"(
@@ -347,14 +527,14 @@ private:
                 player2_combined, player2_win, player2_loss,
                 player3_combined, player3_win, player3_loss)
             VALUES (
-                ?, 1, ?,
+                ?, ?, ?,
                 ?, ?, ?,
                 ?, ?, ?,
                 ?, ?, ?,
                 ?, ?, ?)
             ON CONFLICT (state_data)
             DO UPDATE SET
-                game_count = game_count + 1,
+                game_count = game_count + excluded.game_count,
                 draws = draws + excluded.draws,
                 player0_combined = player0_combined + excluded.player0_combined,
                 player0_win = player0_win + excluded.player0_win,
@@ -387,11 +567,15 @@ private:
     // main thread variables.
     fs::path _dataDir;
     std::size_t _maximumUpdateQueueSize{50}; ///< The maximum number of update lists in the queue, until backend blocks.
+    std::size_t _aggregationSize{20'000}; ///< The number of distinct states in the update buffer, that triggers a flush.
+    std::chrono::milliseconds _flushInterval{0}; ///< The time after that the update buffer is flushed, or zero.
     std::optional<int64_t> _cacheSize; ///< The size of the cache in pages.
     std::optional<std::string> _journalMode; ///< The journal mode for the db.
     std::optional<std::size_t> _pageSize; ///< The size for a page.
     std::optional<std::string> _synchronousMode; ///< The synchronous mode.
     bool _executeVacuum{false}; ///< Whether to execute a VACUUM before starting.
+    bool _canonicalStates{false}; ///< If all rotations of a state are stored as one canonical state.
+    bool _binaryKeys{false}; ///< If the states are stored in their binary form.
     std::future<void> _updateThread{};
 
     // shared variables
@@ -400,6 +584,11 @@ private:
     std::condition_variable _updateQueueWaitForPush{};
     std::condition_variable _updateQueueWaitForPop{};
     std::vector<DbUpdateListPtr> _updateQueue{};
+    std::mutex _updateBufferMutex{}; ///< Protects the update buffer.
+    std::mutex _updatePushMutex{}; ///< Keeps the flushed lists of the buffer in order, while they are pushed.
+    RatingUpdateBuffer _updateBuffer{}; ///< Combines the updates of the games until they are flushed.
+    std::atomic<std::size_t> _bufferedStateCount{0}; ///< The number of states in the buffer, for the status.
+    std::chrono::steady_clock::time_point _updateBufferStart{}; ///< When the first update was added to the buffer.
 
     // update thread variables.
     std::shared_ptr<sqlite3> _db{};
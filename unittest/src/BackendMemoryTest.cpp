@@ -0,0 +1,229 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "AgentRandom.hpp"
+#include "BackendMemory.hpp"
+#include "GameSimulator.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+class BackendMemoryTest : public el::UnitTest {
+public:
+    [[nodiscard]] static auto simulateGames(const std::size_t count) -> std::vector<GameLog> {
+        PlayerAgents agents{};
+        for (auto &agent : agents) {
+            agent = std::make_shared<AgentRandom>();
+        }
+        GameSimulator simulator{agents};
+        std::vector<GameLog> result;
+        for (std::size_t game = 0; game < count; ++game) {
+            for (std::size_t i = 0; i < agents.size(); ++i) {
+                agents[i]->gameStart(utility::deriveSeed(game + 1, i));
+            }
+            simulator.run();
+            result.emplace_back(simulator.gameLog());
+        }
+        return result;
+    }
+
+    void testConcurrentGames() {
+        const auto gameLogs = simulateGames(4);
+        std::unordered_set<GameState> expectedStates;
+        for (const auto &gameLog : gameLogs) {
+            for (const auto &turn : gameLog) {
+                expectedStates.insert(turn.playerState());
+            }
+        }
+        BackendMemory backend;
+        std::array<std::string_view, 0> args{};
+        backend.initialize(args);
+        {
+            std::vector<std::jthread> threads;
+            for (std::size_t i = 0; i < 8; ++i) {
+                threads.emplace_back([&backend, &gameLogs, i]() {
+                    backend.addGame(gameLogs[i % gameLogs.size()]);
+                });
+            }
+        }
+        REQUIRE(backend.stateCount() == expectedStates.size());
+        REQUIRE(backend.status().starts_with("OK:"));
+        // Every game starts with the same state.
+        const auto startRating = backend.rating(GameState::createStartingGameState());
+        REQUIRE(startRating.has_value());
+        REQUIRE(startRating->ratingCount() == 8);
+    }
+
+    void testShardOption() {
+        BackendMemory backend;
+        std::array<std::string_view, 1> invalidArgs{"--shards=3"};
+        REQUIRE_THROWS(backend.initialize(invalidArgs));
+        std::array<std::string_view, 2> args{"--shards=1", "--expected-states=10000"};
+        backend.initialize(args);
+        for (const auto &gameLog : simulateGames(2)) {
+            backend.addGame(gameLog);
+        }
+        REQUIRE(backend.stateCount() > 0);
+    }
+
+    void testSnapshot() {
+        const auto path = std::filesystem::temp_directory_path() / "metikoro-backend-memory-test.snapshot";
+        std::filesystem::remove(path);
+        const auto gameLogs = simulateGames(4);
+        const auto startState = GameState::createStartingGameState();
+        const auto pathArg = "--snapshot=" + path.string();
+        std::array<std::string_view, 3> args{pathArg, "--snapshot-interval=0", "--shards=4"};
+        std::size_t stateCount = 0;
+        {
+            BackendMemory backend;
+            backend.initialize(args);
+            backend.load();
+            backend.addGame(gameLogs[0]);
+            backend.addGame(gameLogs[1]);
+            // Write an intermediate snapshot, and continue with the mapped snapshot as base.
+            backend.writeSnapshot();
+            REQUIRE(std::filesystem::exists(path));
+            backend.addGame(gameLogs[2]);
+            REQUIRE(backend.rating(startState)->ratingCount() == 3);
+            stateCount = backend.stateCount();
+            backend.shutdown();
+        }
+        {
+            // The shard count is taken from the snapshot.
+            std::array<std::string_view, 1> reloadArgs{pathArg};
+            BackendMemory backend;
+            backend.initialize(reloadArgs);
+            backend.load();
+            REQUIRE(backend.stateCount() == stateCount);
+            REQUIRE(backend.rating(startState)->ratingCount() == 3);
+            backend.addGame(gameLogs[3]);
+            REQUIRE(backend.rating(startState)->ratingCount() == 4);
+            backend.shutdown();
+        }
+        {
+            BackendMemory expected;
+            std::array<std::string_view, 0> noArgs{};
+            expected.initialize(noArgs);
+            for (const auto &gameLog : gameLogs) {
+                expected.addGame(gameLog);
+            }
+            BackendMemory backend;
+            std::array<std::string_view, 1> reloadArgs{pathArg};
+            backend.initialize(reloadArgs);
+            backend.load();
+            REQUIRE(backend.stateCount() == expected.stateCount());
+            for (const auto &gameLog : gameLogs) {
+                for (const auto &turn : gameLog) {
+                    const auto rating = backend.rating(turn.playerState());
+                    const auto expectedRating = expected.rating(turn.playerState());
+                    REQUIRE(rating.has_value());
+                    REQUIRE(rating->ratingCount() == expectedRating->ratingCount());
+                    REQUIRE(rating->draws() == expectedRating->draws());
+                }
+            }
+            // A different shard count or state form does not match the snapshot.
+            BackendMemory otherShards;
+            std::array<std::string_view, 2> otherShardArgs{pathArg, "--shards=8"};
+            otherShards.initialize(otherShardArgs);
+            REQUIRE_THROWS(otherShards.load());
+            BackendMemory otherForm;
+            std::array<std::string_view, 2> otherFormArgs{pathArg, "--canonical-states"};
+            otherForm.initialize(otherFormArgs);
+            REQUIRE_THROWS(otherForm.load());
+        }
+        std::filesystem::remove(path);
+    }
+
+    void testCompactRatings() {
+        const auto path = std::filesystem::temp_directory_path() / "metikoro-backend-memory-compact.snapshot";
+        std::filesystem::remove(path);
+        const auto gameLogs = simulateGames(2);
+        const auto startState = GameState::createStartingGameState();
+        const auto pathArg = "--snapshot=" + path.string();
+        {
+            BackendMemory backend;
+            std::array<std::string_view, 3> args{pathArg, "--snapshot-interval=0", "--compact-ratings"};
+            backend.initialize(args);
+            backend.load();
+            backend.addGame(gameLogs[0]);
+            backend.shutdown();
+        }
+        REQUIRE(StateRatingSnapshot::open(path)->precision() == RatingPrecision::Float);
+        {
+            // A snapshot with 32-bit floats is read, and written again with doubles.
+            BackendMemory backend;
+            std::array<std::string_view, 2> args{pathArg, "--snapshot-interval=0"};
+            backend.initialize(args);
+            backend.load();
+            REQUIRE(backend.rating(startState)->ratingCount() == 1);
+            backend.addGame(gameLogs[1]);
+            REQUIRE(backend.rating(startState)->ratingCount() == 2);
+            backend.shutdown();
+        }
+        const auto snapshot = StateRatingSnapshot::open(path);
+        REQUIRE(snapshot->precision() == RatingPrecision::Double);
+        BackendMemory expected;
+        std::array<std::string_view, 0> noArgs{};
+        expected.initialize(noArgs);
+        expected.addGame(gameLogs[0]);
+        expected.addGame(gameLogs[1]);
+        const auto fingerprint = StateFingerprint::fromState(startState);
+        for (std::size_t i = 0; i < snapshot->shardCount(); ++i) {
+            if (const auto rating = snapshot->shard(i).rating(fingerprint); rating.has_value()) {
+                REQUIRE(std::abs(rating->rating(0).combined() - expected.rating(startState)->rating(0).combined()) < 1e-5);
+            }
+        }
+        // All tables of a snapshot use the same precision.
+        REQUIRE_THROWS(StateRatingSnapshot::write(path, 2, false, [](const std::size_t shardIndex) {
+            return StateRatingTable{shardIndex == 0 ? RatingPrecision::Double : RatingPrecision::Float};
+        }));
+        std::filesystem::remove(std::filesystem::path{path} += ".tmp");
+        std::filesystem::remove(path);
+    }
+
+    void testInvalidSnapshot() {
+        const auto path = std::filesystem::temp_directory_path() / "metikoro-backend-memory-invalid.snapshot";
+        {
+            std::ofstream output{path, std::ios::binary | std::ios::trunc};
+            output << std::string(256, 'x');
+        }
+        REQUIRE_THROWS(StateRatingSnapshot::open(path));
+        StateRatingSnapshot::write(path, 2, false, [](std::size_t) { return StateRatingTable{}; });
+        const auto snapshot = StateRatingSnapshot::open(path);
+        REQUIRE(snapshot->shardCount() == 2);
+        REQUIRE(snapshot->recordCount() == 0);
+        // A truncated snapshot is detected.
+        std::filesystem::resize_file(path, sizeof(StateRatingSnapshot::Header) + 8);
+        REQUIRE_THROWS(StateRatingSnapshot::open(path));
+        // Damaged slots without an empty slot do not hang a lookup.
+        StateRatingTable table;
+        const auto adjustment = RatingAdjustment{std::optional<Player>{Player{0}}};
+        for (uint64_t i = 0; i < 10; ++i) {
+            table.applyAdjustment(StateFingerprint{i, zobrist::mix(i)}, adjustment);
+        }
+        StateRatingSnapshot::write(path, 1, false, [&table](std::size_t) { return table; });
+        const auto slotCount = StateRatingSnapshot::open(path)->shard(0).slotCount();
+        {
+            // The slots are the last array in the file, point all of them to the first record.
+            std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+            file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) - slotCount * sizeof(StateRatingView::Index)));
+            const std::vector<StateRatingView::Index> damagedSlots(slotCount, 0);
+            file.write(reinterpret_cast<const char*>(damagedSlots.data()),
+                static_cast<std::streamsize>(damagedSlots.size() * sizeof(StateRatingView::Index)));
+        }
+        const auto damagedSnapshot = StateRatingSnapshot::open(path);
+        REQUIRE_FALSE(damagedSnapshot->shard(0).rating(StateFingerprint{100, zobrist::mix(100)}).has_value());
+        REQUIRE(damagedSnapshot->shard(0).rating(StateFingerprint{0, zobrist::mix(0)}).has_value());
+        std::filesystem::remove(path);
+    }
+};
@@ -53,4 +53,48 @@ public:
         REQUIRE(field.orientation() == Orientation::North);
         REQUIRE(Board::isGarden(Position{1, 1}));
     }
+
+    void testFrameRotation() {
+        board = {};
+        for (const auto rotation : Rotation::allClockwise()) {
+            for (Length y = 0; y < setup::boardSize; ++y) {
+                for (Length x = 0; x < setup::boardSize; ++x) {
+                    const auto position = Position{x, y};
+                    if (not Board::isStatic(position)) {
+                        continue;
+                    }
+                    const auto rotatedPosition = Board::rotatedPosition(rotation, position);
+                    REQUIRE(Board::isStatic(rotatedPosition));
+                    REQUIRE(board.field(position).rotated(rotation) == board.field(rotatedPosition));
+                }
+            }
+        }
+        // The garden of player 1 is next to the house at the bottom-left corner.
+        REQUIRE(Board::playerForField(Position{1, 8}) == Player{1});
+        REQUIRE(Board::rotatedPosition(Rotation::Clockwise90, Position{1, 8}) == Position{1, 1});
+    }
+
+    void testPlanes() {
+        board = {};
+        REQUIRE(board.planes().occupied.empty());
+        REQUIRE(board.allPlaceOneActionPositions().size() == 60 - 3 * 6);
+        REQUIRE(board.canPlayerPlaceStone(Position{1, 1})); // own garden
+        REQUIRE_FALSE(board.canPlayerPlaceStone(Position{8, 8})); // garden of player 2
+        REQUIRE_FALSE(board.canPlayerPlaceStone(Position{4, 4})); // source
+        board.setField(Position{3, 4}, Stone::SwitchA, Orientation::West);
+        board.setField(Position{2, 4}, Stone::Crossing, Orientation::North);
+        REQUIRE(board.planes().occupied.count() == 2);
+        REQUIRE(board.planes().stop.empty());
+        REQUIRE(board.planes().rotatable.count() == 1);
+        REQUIRE_FALSE(board.canPlayerPlaceStone(Position{3, 4}));
+        REQUIRE(board.allReplaceOneActionPositions() == PositionList{Position{2, 4}, Position{3, 4}});
+        REQUIRE(board.allRotateOneActionPositions() == PositionList{Position{3, 4}});
+        board.setField(Position{3, 4}, Stone::Empty, Orientation::North);
+        REQUIRE(board.planes().occupied.count() == 1);
+        REQUIRE(board.planes().rotatable.empty());
+        REQUIRE(board.canPlayerPlaceStone(Position{3, 4}));
+        std::string data;
+        board.addToData(data);
+        REQUIRE(Board::fromData(data) == board);
+    }
 };
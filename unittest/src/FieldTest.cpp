@@ -157,5 +157,27 @@ public:
         field = field.rotated(Rotation::Clockwise90);
         REQUIRE(field.orientation() == Orientation::North);
     }
+
+    void testConnectionTable() {
+        for (const auto stone : Stone::all()) {
+            for (const auto orientation : Orientation::all()) {
+                field.setStone(stone, orientation);
+                for (const auto entry : Anchor::all()) {
+                    // The table must match the wiring, rotated for the orientation of the stone.
+                    const auto expected = stone.connectionsFrom(entry.normalized(orientation)).rotated(orientation);
+                    REQUIRE(connection::exitsFrom(stone, orientation, entry) == expected);
+                    const auto expectedForField = stone.connectionsFrom(
+                        entry.normalized(field.orientation())).rotated(field.orientation());
+                    REQUIRE(field.connectionsFrom(entry) == expectedForField);
+                    // Every connection can be traveled in both directions.
+                    for (const auto exit : Anchor::all()) {
+                        if (connection::exitsFrom(stone, orientation, entry).contains(exit)) {
+                            REQUIRE(connection::exitsFrom(stone, orientation, exit).contains(entry));
+                        }
+                    }
+                }
+            }
+        }
+    }
 };
 
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "AgentRandom.hpp"
+#include "GameArena.hpp"
+#include "GameState.hpp"
+#include "SimulationContext.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+thread_local bool countAllocations = false; ///< If heap allocations of this thread are counted.
+thread_local std::size_t allocationCount = 0; ///< The number of counted heap allocations.
+}
+
+
+// Count the heap allocations, to verify that the games in a context do not allocate in steady state.
+auto operator new(const std::size_t size) -> void* {
+    if (countAllocations) {
+        allocationCount += 1;
+    }
+    if (auto *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+
+class GameArenaTest : public el::UnitTest {
+public:
+    void testScope() {
+        REQUIRE(GameArena::current() == nullptr);
+        REQUIRE(GameArena::currentResource() == std::pmr::new_delete_resource());
+        GameArena outerArena;
+        GameArena innerArena;
+        {
+            GameArena::Scope const outerScope{outerArena};
+            REQUIRE(GameArena::current() == &outerArena);
+            {
+                GameArena::Scope const innerScope{innerArena};
+                REQUIRE(GameArena::current() == &innerArena);
+                REQUIRE(GameArena::currentResource() == innerArena.resource());
+            }
+            REQUIRE(GameArena::current() == &outerArena);
+        }
+        REQUIRE(GameArena::current() == nullptr);
+    }
+
+    void testOrbMovesFromArena() {
+        const auto state = GameState::createStartingGameState();
+        GameArena arena;
+        for (int round = 0; round < 3; ++round) {
+            GameArena::Scope const scope{arena};
+            const auto moves = state.allOrbMoves();
+            REQUIRE_FALSE(moves.empty());
+            REQUIRE(moves.moves().get_allocator().resource() == arena.resource());
+            const auto copiedMoves = moves;
+            REQUIRE(copiedMoves == moves);
+            REQUIRE(copiedMoves.moves().get_allocator().resource() == arena.resource());
+        }
+        arena.release();
+        const auto heapMoves = state.allOrbMoves();
+        REQUIRE(heapMoves.moves().get_allocator().resource() == std::pmr::new_delete_resource());
+    }
+
+    void testContextRunsSameGames() {
+        // Running games in a context with an arena must not change the games.
+        PlayerAgents configuredAgents{};
+        for (auto &agent : configuredAgents) {
+            agent = std::make_shared<AgentRandom>();
+        }
+        SimulationContext context{configuredAgents};
+        for (uint64_t game = 1; game <= 3; ++game) {
+            const auto gameSeed = utility::deriveSeed(42, game);
+            PlayerAgents agents{};
+            for (std::size_t i = 0; i < agents.size(); ++i) {
+                agents[i] = std::make_shared<AgentRandom>();
+                agents[i]->gameStart(utility::deriveSeed(gameSeed, i));
+            }
+            GameSimulator simulator{agents};
+            const auto expectedState = simulator.run();
+            const auto &gameLog = context.runGame(gameSeed);
+            REQUIRE(gameLog.size() == simulator.gameLog().size());
+            REQUIRE(gameLog.lastState() == expectedState);
+            REQUIRE(gameLog.winningPlayer() == simulator.gameLog().winningPlayer());
+            REQUIRE(GameArena::current() == nullptr);
+        }
+    }
+
+    void testSteadyStateGamesDoNotAllocate() {
+        PlayerAgents configuredAgents{};
+        for (auto &agent : configuredAgents) {
+            agent = std::make_shared<AgentRandom>();
+        }
+        SimulationContext context{configuredAgents};
+        // Let the buffers of the context grow to their steady size.
+        for (uint64_t game = 1; game <= 20; ++game) {
+            context.runGame(utility::deriveSeed(7, game));
+        }
+        std::size_t turnCount = 0;
+        allocationCount = 0;
+        for (uint64_t game = 21; game <= 30; ++game) {
+            countAllocations = true;
+            const auto &gameLog = context.runGame(utility::deriveSeed(7, game));
+            countAllocations = false;
+            turnCount += gameLog.size();
+        }
+        REQUIRE(turnCount > 0);
+        REQUIRE(allocationCount == 0);
+    }
+};
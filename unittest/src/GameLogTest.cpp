@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "AgentRandom.hpp"
+#include "GameLog.hpp"
+
+#include <vector>
+
+
+class GameLogTest : public el::UnitTest {
+public:
+    /// Play a game without the simulator, and keep all states for comparison.
+    ///
+    void recordGame(GameLog &gameLog, std::vector<GameState> &states, const uint64_t seed) {
+        AgentRandom agent;
+        agent.gameStart(seed);
+        auto state = GameState::createStartingGameState();
+        auto player = Player{0};
+        std::size_t turn = 0;
+        for (; turn < 150 and not state.hasWinner(); ++turn, player.next()) {
+            const auto gameMove = agent.nextMoveForPlayer(state, player, gameLog);
+            gameLog.addTurn(turn, player, state, gameMove);
+            states.emplace_back(state);
+            state.executeMove(gameMove, player);
+        }
+        gameLog.addLastState(turn, player, state);
+        states.emplace_back(state);
+    }
+
+    void testReplay() {
+        GameLog gameLog;
+        std::vector<GameState> states;
+        recordGame(gameLog, states, 42);
+        REQUIRE(gameLog.size() == states.size());
+        REQUIRE(gameLog.size() > GameLog::keyframeInterval * 2);
+        std::size_t index = 0;
+        for (const auto &turn : gameLog) {
+            REQUIRE(turn.turn == index);
+            REQUIRE(turn.state == states[index]);
+            index += 1;
+        }
+        REQUIRE(index == states.size());
+        REQUIRE(gameLog.lastState() == states.back());
+        REQUIRE(gameLog.turn(gameLog.size() - 1).gameMove == GameMove{});
+    }
+
+    void testRandomAccess() {
+        GameLog gameLog;
+        std::vector<GameState> states;
+        recordGame(gameLog, states, 7);
+        for (const auto index : {std::size_t{0}, GameLog::keyframeInterval - 1, GameLog::keyframeInterval,
+                GameLog::keyframeInterval + 5, states.size() - 2, states.size() - 1}) {
+            const auto turn = gameLog.turn(index);
+            REQUIRE(turn.turn == index);
+            REQUIRE(turn.state == states[index]);
+        }
+        REQUIRE_THROWS(gameLog.turn(states.size()));
+        const auto adjustments = gameLog.createRatingAdjustments();
+        REQUIRE(adjustments.size() == gameLog.size());
+        gameLog.clear();
+        REQUIRE(gameLog.empty());
+        REQUIRE(gameLog.begin() == gameLog.end());
+    }
+};
+
@@ -4,12 +4,18 @@
 
 #include <erbsland/unittest/UnitTest.hpp>
 
+#include "ActionGenerator.hpp"
 #include "GameState.hpp"
+#include "RatingAdjustment.hpp"
 
+#include <algorithm>
+#include <random>
 #include <set>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 
 class GameStateTest : public el::UnitTest {
@@ -65,6 +71,298 @@ public:
         REQUIRE(state.orbsInHouse() == std::array<uint8_t, 4>{0, 0, 0, 3});
     }
 
+    void testZobristKey() {
+        state = GameState::createStartingGameState();
+        const auto startKey = state.zobristKey();
+        REQUIRE(startKey != 0);
+        REQUIRE(GameState::fromData(state.toData()).zobristKey() == startKey);
+        REQUIRE(state.rotated(Rotation::Clockwise90).zobristKey() == startKey); // the start is symmetric.
+        std::mt19937_64 rng{42};
+        std::unordered_set<zobrist::Key> keys;
+        keys.insert(startKey);
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            const auto actions = state.allActions().actions();
+            REQUIRE_FALSE(actions.empty());
+            const auto actionSequence = actions.at(rng() % actions.size());
+            const auto afterAction = state.afterAction(actionSequence);
+            const auto draws = afterAction.allRegularDraws();
+            const auto orbMoves = afterAction.allOrbMoves();
+            const auto drawStone = draws.empty() ? Stone{} : draws.at(rng() % draws.size());
+            state.executeMove(GameMove{actionSequence, drawStone, orbMoves.at(rng() % orbMoves.size())});
+            // The incrementally updated key must match the one of a freshly parsed state.
+            REQUIRE(GameState::fromData(state.toData()).zobristKey() == state.zobristKey());
+            state = state.rotated(Rotation::Clockwise90);
+            REQUIRE(GameState::fromData(state.toData()).zobristKey() == state.zobristKey());
+            REQUIRE(std::hash<GameState>{}(state) == state.zobristKey());
+            keys.insert(state.zobristKey());
+        }
+        REQUIRE(keys.size() > 20);
+    }
+
+    void testForEachMove() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 12 and not state.hasWinner(); ++turn) {
+            // The streamed moves match the cross product of actions, draws and orb moves.
+            std::size_t expectedCount = 0;
+            const auto actionSequences = state.allActions();
+            std::size_t actionIndex = 0;
+            bool sameOrder = true;
+            REQUIRE(ActionSequences::forEachForState(state, [&](const ActionSequence &actionSeq) {
+                sameOrder &= actionIndex < actionSequences.actions().size()
+                    and actionSeq == actionSequences.actions()[actionIndex];
+                actionIndex += 1;
+                const auto stateAfterAction = state.afterAction(actionSeq);
+                expectedCount += stateAfterAction.allRegularDraws().size() * stateAfterAction.allOrbMoves().size();
+                return true;
+            }));
+            REQUIRE(sameOrder);
+            REQUIRE(actionIndex == actionSequences.actions().size());
+            std::size_t count = 0;
+            REQUIRE(state.forEachMove([&count](const GameMove&) { count += 1; }));
+            REQUIRE(count == expectedCount);
+            // Stop early.
+            count = 0;
+            REQUIRE_FALSE(state.forEachMove([&count](const GameMove&) { count += 1; return count < 10; }));
+            REQUIRE(count == 10);
+            // The streamed orb moves match the list, and stop at any move.
+            const auto orbMoves = state.allOrbMoves();
+            std::vector<OrbMove> streamedOrbMoves;
+            REQUIRE(OrbMoves::forEachForState(state, [&](const OrbMove &orbMove) { streamedOrbMoves.push_back(orbMove); }));
+            REQUIRE(std::ranges::equal(streamedOrbMoves, orbMoves.moves()));
+            const auto stopCount = 1 + rng() % orbMoves.size();
+            std::size_t orbMoveCount = 0;
+            REQUIRE_FALSE(OrbMoves::forEachForState(state, [&](const OrbMove&) { orbMoveCount += 1; return orbMoveCount < stopCount; }));
+            REQUIRE(orbMoveCount == stopCount);
+            const auto moves = state.allMoves();
+            REQUIRE(moves.size() == expectedCount);
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
+
+    void testActionGenerator() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 12 and not state.hasWinner(); ++turn) {
+            const ActionGenerator generator{state};
+            const auto actionSequences = generator.all();
+            const auto &actions = actionSequences.actions();
+            REQUIRE_FALSE(actions.empty());
+            REQUIRE(generator.countAllActions() == actions.size());
+            // Unranking matches the generated list, at the borders of each family and at random indexes.
+            std::size_t familyStart = 0;
+            for (const auto familyCount : generator.countFamilies()) {
+                if (familyCount > 0) {
+                    REQUIRE(generator.actionAt(familyStart) == actions[familyStart]);
+                    REQUIRE(generator.actionAt(familyStart + familyCount - 1) == actions[familyStart + familyCount - 1]);
+                }
+                familyStart += familyCount;
+            }
+            const auto census = generator.census();
+            REQUIRE(census.total() == actions.size());
+            for (int i = 0; i < 50; ++i) {
+                const auto index = rng() % actions.size();
+                REQUIRE(generator.actionAt(index) == actions[index]);
+                REQUIRE(ActionGenerator::actionAt(census, index) == actions[index]);
+            }
+            REQUIRE_THROWS(generator.actionAt(actions.size()));
+            REQUIRE_THROWS(ActionGenerator::actionAt(census, actions.size()));
+            // The per-thread buffer is reused, so a second pass must produce the same list.
+            REQUIRE(generator.all().actions() == actions);
+            const std::set<std::string> uniqueActions = [&] {
+                std::set<std::string> result;
+                for (const auto &actionSeq : actions) {
+                    result.insert(actionSeq.toString());
+                }
+                return result;
+            }();
+            REQUIRE(uniqueActions.size() == actions.size());
+            // Stop early, at a random action.
+            const auto stopIndex = rng() % actions.size();
+            std::size_t count = 0;
+            bool sameOrder = true;
+            REQUIRE_FALSE(generator.forEachAction([&](const ActionSequence &actionSeq) {
+                sameOrder &= actionSeq == actions[count];
+                count += 1;
+                return count <= stopIndex;
+            }));
+            REQUIRE(sameOrder);
+            REQUIRE(count == stopIndex + 1);
+            const auto moves = state.allMoves();
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
+
+    void testCanonicalActions() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        bool hasDuplicates = false;
+        for (int turn = 0; turn < 16 and not state.hasWinner(); ++turn) {
+            const auto allActions = state.allActions();
+            const auto canonicalActions = state.allActions(Player{0}, ActionSequences::Mode::Canonical);
+            std::unordered_set<GameState> allStates;
+            for (const auto &actionSeq : allActions.actions()) {
+                allStates.insert(state.afterAction(actionSeq));
+            }
+            std::unordered_set<GameState> canonicalStates;
+            for (const auto &actionSeq : canonicalActions.actions()) {
+                canonicalStates.insert(state.afterAction(actionSeq));
+            }
+            // The same states are reachable, but with only one action sequence for each of them.
+            REQUIRE(canonicalStates == allStates);
+            REQUIRE(canonicalActions.actions().size() == canonicalStates.size());
+            hasDuplicates |= allActions.actions().size() > allStates.size();
+            const ActionGenerator generator{state, Player{0}, ActionSequences::Mode::Canonical};
+            REQUIRE(generator.countAllActions() == canonicalActions.actions().size());
+            const auto index = rng() % canonicalActions.actions().size();
+            REQUIRE(generator.actionAt(index) == canonicalActions.actions()[index]);
+            const auto moves = state.allMoves(Player{0}, ActionSequences::Mode::Canonical);
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+        REQUIRE(hasDuplicates); // Make sure the test covers states with duplicate action sequences.
+    }
+
+    void testUndo() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{7};
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            const auto actions = state.allActions().actions();
+            REQUIRE_FALSE(actions.empty());
+            const auto actionSequence = actions.at(rng() % actions.size());
+            const auto originalState = state;
+            auto undo = state.executeActions(actionSequence);
+            const auto draws = state.allRegularDraws();
+            const auto orbMoves = state.allOrbMoves();
+            state.undo(undo);
+            REQUIRE(state == originalState);
+            REQUIRE(state.zobristKey() == originalState.zobristKey());
+            const auto drawStone = draws.empty() ? Stone{} : draws.at(rng() % draws.size());
+            const auto move = GameMove{actionSequence, drawStone, orbMoves.at(rng() % orbMoves.size())};
+            undo = state.executeMove(move);
+            const auto stateAfterMove = state;
+            state.undo(undo);
+            REQUIRE(state == originalState);
+            REQUIRE(state.zobristKey() == originalState.zobristKey());
+            REQUIRE(state.toData() == originalState.toData());
+            state.executeMove(move);
+            REQUIRE(state == stateAfterMove);
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
+
+    void testUndoKoLockDecay() {
+        const auto position = Position{3, 3};
+        state = GameState::createStartingGameState();
+        state.board().setField(position, Stone::TwoCurves, Orientation::North);
+        // Add a ko lock of one to the field, which decays at the start of the next move.
+        std::string fieldData;
+        state.board().field(position).addToData(fieldData);
+        auto data = state.toData();
+        const auto fieldIndex = data.find(fieldData);
+        REQUIRE(fieldIndex != std::string::npos);
+        REQUIRE(data.find(fieldData, fieldIndex + 1) == std::string::npos);
+        data[fieldIndex + fieldData.size() - 1] = '1';
+        state = GameState::fromData(data);
+        REQUIRE(state.board().field(position).koLock() == 1);
+        auto unlockedState = state;
+        unlockedState.nextTurn();
+        std::size_t testedSequences = 0;
+        for (const auto &actionSequence : unlockedState.allActions().actions()) {
+            const auto touchesField = std::ranges::any_of(actionSequence.sequence(), [&](const Action &action) {
+                return not action.isNone() and action.position() == position;
+            });
+            if (not touchesField) {
+                continue;
+            }
+            const auto originalState = state;
+            const auto undo = state.executeMove(GameMove{actionSequence, Stone{}, OrbMove{}});
+            state.undo(undo);
+            REQUIRE(state == originalState);
+            REQUIRE(state.board().field(position).koLock() == 1);
+            REQUIRE(state.zobristKey() == originalState.zobristKey());
+            REQUIRE(state.toData() == originalState.toData());
+            testedSequences += 1;
+        }
+        REQUIRE(testedSequences > 0);
+    }
+
+    void testCanonicalRotation() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            const auto canonicalState = state.rotated(state.canonicalRotation());
+            for (const auto rotation : Rotation::allClockwise()) {
+                const auto rotatedState = state.rotated(rotation);
+                REQUIRE(state.zobristKey(rotation) == rotatedState.zobristKey());
+                REQUIRE(rotatedState.rotated(rotatedState.canonicalRotation()) == canonicalState);
+            }
+            const auto moves = state.allMoves();
+            REQUIRE_FALSE(moves.empty());
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+        // Rotating a state moves the next player to the top-left corner, the ratings have to follow.
+        auto rating = RatingAdjustment{Player{1}};
+        rating.rotate(Rotation::Clockwise90);
+        REQUIRE(rating.rating(0).win() == RatingAdjustment::deltaForWin);
+        REQUIRE(rating.rating(3).win() == 0.0);
+    }
+
+    void testPerspective() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{11};
+        Player player{0};
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            auto playerState = state.rotatedToPlayer(player);
+            REQUIRE(playerState.rotatedForPlayer(player) == state);
+            const auto actions = playerState.allActions().actions();
+            REQUIRE_FALSE(actions.empty());
+            REQUIRE(state.allActions(player).actions().size() == actions.size());
+            const auto actionSequence = actions.at(rng() % actions.size());
+            const auto undo = playerState.executeActions(actionSequence);
+            const auto draws = playerState.allRegularDraws();
+            const auto orbMoves = playerState.allOrbMoves();
+            playerState.undo(undo);
+            const auto drawStone = draws.empty() ? Stone{} : draws.at(rng() % draws.size());
+            const auto move = GameMove{actionSequence, drawStone, orbMoves.at(rng() % orbMoves.size())};
+            const auto originalMove = move.rotated(GameState::rotationToPlayer(player).reversed());
+            const auto stateAfterActions = state.afterAction(originalMove.actions(), player);
+            REQUIRE(stateAfterActions.allRegularDraws(player).size() == draws.size());
+            REQUIRE(stateAfterActions.allOrbMoves(player).size() == orbMoves.size());
+            playerState.executeMove(move);
+            state.executeMove(originalMove, player);
+            REQUIRE(state.rotatedToPlayer(player) == playerState);
+            player.next();
+        }
+    }
+
+    void testBinarySerialization() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            const auto data = state.toBinary();
+            REQUIRE(data.size() < GameState::dataSize() / 2);
+            REQUIRE(static_cast<uint8_t>(data.front()) == GameState::binaryVersion);
+            const auto deserializedState = GameState::fromBinary(data);
+            REQUIRE(deserializedState == state);
+            REQUIRE(deserializedState.zobristKey() == state.zobristKey());
+            REQUIRE(deserializedState.toBinary() == data);
+            // Truncated data, trailing data and unknown versions are rejected.
+            REQUIRE_THROWS(GameState::fromBinary(data.substr(0, data.size() - 1)));
+            REQUIRE_THROWS(GameState::fromBinary(data + '\0'));
+            auto wrongVersion = data;
+            wrongVersion.front() = static_cast<char>(GameState::binaryVersion + 1);
+            REQUIRE_THROWS(GameState::fromBinary(wrongVersion));
+            const auto moves = state.allMoves();
+            REQUIRE_FALSE(moves.empty());
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
+
     void testSerialization() {
         // Set up a board
         state = GameState::createStartingGameState();
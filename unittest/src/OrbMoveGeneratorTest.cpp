@@ -7,6 +7,8 @@
 #include "GameState.hpp"
 #include "OrbMoveGenerator.hpp"
 
+#include <random>
+
 
 
 #define GENERATOR_SETUP() OrbMoveGenerator gen(state, this);
@@ -150,4 +152,47 @@ public:
         REQUIRE(moves.size() == 1);
         REQUIRE(moves[0].isNoMove());
     }
+
+    void testGraphMatchesAllPaths() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 40 and not state.hasWinner(); ++turn) {
+            const auto graph = OrbGraph{state.board(), Player{0}};
+            OrbMoveGenerator<> gen{state};
+            for (const auto orbPosition : state.orbPositions().positions()) {
+                if (orbPosition.position.isInvalid()) {
+                    break;
+                }
+                OrbGraph::Mask expected;
+                gen.followAllPaths(orbPosition.position, [&](const PositionPair &pair, const OrbTravelNodeStack &) {
+                    expected.set(pair.second);
+                });
+                REQUIRE(graph.stopsFrom(orbPosition.position) == expected);
+            }
+            const auto moves = state.allMoves();
+            REQUIRE_FALSE(moves.empty());
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
+
+    void testCacheMatchesGenerator() {
+        state = GameState::createStartingGameState();
+        std::mt19937_64 rng{3};
+        for (int turn = 0; turn < 24 and not state.hasWinner(); ++turn) {
+            auto cache = OrbMoveCache{state.board(), state.orbPositions(), Player{0}};
+            REQUIRE(cache.orbMoves() == state.allOrbMoves());
+            auto workingState = state;
+            const auto actionSequences = state.allActions();
+            for (const auto &actionSequence : actionSequences.actions()) {
+                const auto undo = workingState.executeActions(actionSequence);
+                REQUIRE(cache.orbMoves(workingState.board(), undo.changedPositions()) == workingState.allOrbMoves());
+                workingState.undo(undo);
+            }
+            const auto moves = state.allMoves();
+            REQUIRE_FALSE(moves.empty());
+            state.executeMove(moves.at(rng() % moves.size()));
+            state = state.rotated(Rotation::Clockwise90);
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "Perft.hpp"
+
+#include <fstream>
+#include <sstream>
+
+
+class PerftTest : public el::UnitTest {
+public:
+    std::string stateData;
+
+    auto additionalErrorMessages() -> std::string override {
+        return "State: " + stateData;
+    }
+
+    void testReference() {
+        std::ifstream input{METIKORO_PERFT_REFERENCE};
+        REQUIRE(input.is_open());
+        const auto references = PerftReference::readAll(input);
+        REQUIRE(references.size() >= 10);
+        for (const auto &reference : references) {
+            stateData = reference.state.toData();
+            const auto perft = Perft{reference.depth, reference.mode};
+            REQUIRE(perft.count(reference.state) == reference.expected);
+        }
+    }
+
+    void testStartState() {
+        // At depth 1, the counts are the sizes of the move lists of the state.
+        const auto state = GameState::createStartingGameState();
+        stateData = state.toData();
+        const auto counts = Perft{1, ActionSequences::Mode::All}.count(state);
+        REQUIRE(counts.actions == state.allActions().actions().size());
+        REQUIRE(counts.orbMoves == state.allOrbMoves().size());
+        REQUIRE(counts.moves == state.allMoves().size());
+    }
+
+    void testReferenceLines() {
+        const auto state = GameState::createStartingGameState();
+        const auto perft = Perft{2, ActionSequences::Mode::Canonical};
+        std::stringstream input;
+        input << "# comment\n\n" << PerftReference::toLine(state, perft, PerftCounts{1, 2, 3}) << "\n";
+        const auto references = PerftReference::readAll(input);
+        REQUIRE(references.size() == 1);
+        REQUIRE(references[0].state == state);
+        REQUIRE(references[0].depth == 2);
+        REQUIRE(references[0].mode == ActionSequences::Mode::Canonical);
+        REQUIRE(references[0].expected == (PerftCounts{1, 2, 3}));
+        std::stringstream invalidInput{state.toData() + " 1 unknown 1 2 3\n"};
+        REQUIRE_THROWS(PerftReference::readAll(invalidInput));
+    }
+};
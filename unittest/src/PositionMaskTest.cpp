@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "PositionMask.hpp"
+
+
+class PositionMaskTest : public el::UnitTest {
+public:
+    using StateMask = PositionMask<8, 1>;
+    using BoardMask = PositionMask<10>;
+
+    void testDefault() {
+        BoardMask mask;
+        REQUIRE(mask.empty());
+        REQUIRE(mask.count() == 0);
+        REQUIRE(StateMask::wordCount == 1);
+        REQUIRE(BoardMask::wordCount == 2);
+    }
+
+    void testSetAndReset() {
+        BoardMask mask;
+        mask.set(Position{0, 0});
+        mask.set(Position{9, 9});
+        mask.set(Position{3, 6}); // index 63
+        mask.set(Position{4, 6}); // index 64, second word.
+        REQUIRE(mask.count() == 4);
+        REQUIRE(mask.test(Position{0, 0}));
+        REQUIRE(mask.test(Position{9, 9}));
+        REQUIRE(mask.test(Position{3, 6}));
+        REQUIRE(mask.test(Position{4, 6}));
+        REQUIRE_FALSE(mask.test(Position{1, 0}));
+        REQUIRE_FALSE(mask.test(Position::invalid()));
+        mask.reset(Position{3, 6});
+        REQUIRE_FALSE(mask.test(Position{3, 6}));
+        REQUIRE(mask.count() == 3);
+        mask.set(Position::invalid()); // ignored
+        REQUIRE(mask.count() == 3);
+    }
+
+    void testOffset() {
+        StateMask mask;
+        mask.set(Position{0, 0}); // outside, ignored.
+        mask.set(Position{1, 1});
+        mask.set(Position{8, 8});
+        mask.set(Position{9, 9}); // outside, ignored.
+        REQUIRE(mask.count() == 2);
+        REQUIRE(mask.words()[0] == ((uint64_t{1} << 63U) | 1U));
+        REQUIRE(mask.test(Position{1, 1}));
+        REQUIRE(mask.test(Position{8, 8}));
+        REQUIRE_FALSE(mask.test(Position{0, 0}));
+    }
+
+    void testOperators() {
+        BoardMask a;
+        BoardMask b;
+        a.set(Position{1, 1});
+        a.set(Position{2, 8});
+        b.set(Position{2, 8});
+        b.set(Position{7, 7});
+        REQUIRE((a & b).count() == 1);
+        REQUIRE((a & b).test(Position{2, 8}));
+        REQUIRE((a | b).count() == 3);
+        REQUIRE((a ^ b).count() == 2);
+        REQUIRE((~a).count() == 98);
+        REQUIRE((~BoardMask{}).count() == 100);
+        REQUIRE((~StateMask{}).count() == 64);
+    }
+
+    void testIterationOrder() {
+        const auto positions = PositionList{
+            Position{5, 1}, Position{2, 3}, Position{8, 1}, Position{1, 8}, Position{1, 2}};
+        const auto mask = StateMask::fromPositions(positions);
+        auto expected = positions;
+        std::ranges::sort(expected);
+        REQUIRE(mask.toPositions() == expected);
+        const auto converted = BoardMask::from(mask);
+        REQUIRE(converted.toPositions() == expected);
+        REQUIRE(StateMask::from(converted) == mask);
+    }
+};
+
@@ -0,0 +1,51 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "RatingUpdateBuffer.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+
+class RatingUpdateBufferTest : public el::UnitTest {
+public:
+    void testMergeInFirstSeenOrder() {
+        RatingUpdateBuffer buffer;
+        REQUIRE(buffer.empty());
+        const auto win = RatingAdjustment{std::optional<Player>{Player{0}}};
+        const auto draw = RatingAdjustment{std::optional<Player>{}};
+        // Three games, that all start with the same state.
+        for (const auto &keys : {std::vector<std::string>{"start", "a", "b"},
+                std::vector<std::string>{"start", "c"},
+                std::vector<std::string>{"start", "a", "d"}}) {
+            for (auto key : keys) {
+                buffer.add(std::move(key), keys.size() == 2 ? draw : win);
+            }
+        }
+        REQUIRE(buffer.size() == 5);
+        REQUIRE(buffer.adjustmentCount() == 8);
+        const auto updates = buffer.take();
+        REQUIRE(buffer.empty());
+        REQUIRE(buffer.adjustmentCount() == 0);
+        REQUIRE(updates.size() == 5);
+        REQUIRE(updates[0].stateKey == "start");
+        REQUIRE(updates[1].stateKey == "a");
+        REQUIRE(updates[2].stateKey == "b");
+        REQUIRE(updates[3].stateKey == "c");
+        REQUIRE(updates[4].stateKey == "d");
+        REQUIRE(updates[0].rating.ratingCount() == 3);
+        REQUIRE(updates[0].rating.draws() == draw.draws());
+        REQUIRE(updates[0].rating.rating(0).win() == 2 * win.rating(0).win());
+        REQUIRE(updates[1].rating.ratingCount() == 2);
+        REQUIRE(updates[3].rating.ratingCount() == 1);
+        // The buffer can be reused after taking the updates.
+        buffer.add("a", win);
+        REQUIRE(buffer.size() == 1);
+        REQUIRE(buffer.take().front().rating.ratingCount() == 1);
+    }
+};
+
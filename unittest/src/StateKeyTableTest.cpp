@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "AgentRandom.hpp"
+#include "GameSimulator.hpp"
+#include "StateKeyTable.hpp"
+
+#include <format>
+
+
+class StateKeyTableTest : public el::UnitTest {
+public:
+    void testInsertAndContains() {
+        StateKeyTable table;
+        REQUIRE(table.empty());
+        REQUIRE_FALSE(table.contains(42));
+        REQUIRE(table.insert(42));
+        REQUIRE_FALSE(table.insert(42));
+        REQUIRE(table.contains(42));
+        REQUIRE(table.size() == 1);
+        // Zero is the value of empty slots, and stored separately.
+        REQUIRE_FALSE(table.contains(0));
+        REQUIRE(table.insert(0));
+        REQUIRE_FALSE(table.insert(0));
+        REQUIRE(table.contains(0));
+        // Keys with the same low bits collide in the same slot.
+        const auto collidingKey = 42U + (StateKeyTable::initialCapacity * 7U);
+        REQUIRE_FALSE(table.contains(collidingKey));
+        REQUIRE(table.insert(collidingKey));
+        REQUIRE(table.contains(collidingKey));
+        REQUIRE(table.contains(42));
+    }
+
+    void testGrowAndClear() {
+        StateKeyTable table;
+        for (uint64_t i = 1; i <= 10'000; ++i) {
+            REQUIRE(table.insert(zobrist::mix(i)));
+        }
+        REQUIRE(table.size() == 10'000);
+        REQUIRE(table.capacity() >= 20'000);
+        for (uint64_t i = 1; i <= 10'000; ++i) {
+            REQUIRE(table.contains(zobrist::mix(i)));
+        }
+        REQUIRE_FALSE(table.contains(zobrist::mix(10'001)));
+        const auto capacity = table.capacity();
+        table.clear();
+        REQUIRE(table.empty());
+        REQUIRE(table.capacity() == capacity);
+        REQUIRE_FALSE(table.contains(zobrist::mix(1)));
+        REQUIRE(table.insert(zobrist::mix(1)));
+    }
+
+    void testSimulatorReuseAndVerify() {
+        // Reusing a simulator and verifying the keys must not change the games.
+        auto createAgents = []() -> PlayerAgents {
+            PlayerAgents agents{};
+            for (std::size_t i = 0; i < agents.size(); ++i) {
+                auto agent = std::make_shared<AgentRandom>();
+                auto seedArg = std::format("--seed={}", i + 1);
+                std::array<std::string_view, 1> args{seedArg};
+                agent->initialize(args);
+                agents[i] = agent;
+            }
+            return agents;
+        };
+        GameSimulator reusedSimulator{createAgents()};
+        reusedSimulator.setVerifyRepetitions(true);
+        for (int game = 0; game < 3; ++game) {
+            GameSimulator freshSimulator{createAgents()};
+            for (int skip = 0; skip < game; ++skip) {
+                freshSimulator.run();
+            }
+            const auto expectedState = freshSimulator.run();
+            const auto state = reusedSimulator.run();
+            REQUIRE(state == expectedState);
+            REQUIRE(reusedSimulator.gameLog().size() == freshSimulator.gameLog().size());
+            REQUIRE(reusedSimulator.keyCollisionCount() == 0);
+        }
+    }
+};
+
@@ -0,0 +1,98 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "StateRatingTable.hpp"
+
+#include <cmath>
+
+
+class StateRatingTableTest : public el::UnitTest {
+public:
+    void testRatingMatchesAdjustments() {
+        const auto state = GameState::createStartingGameState();
+        const auto fingerprint = StateFingerprint::fromState(state);
+        REQUIRE(fingerprint == StateFingerprint::fromState(state));
+        StateRatingTable table;
+        REQUIRE_FALSE(table.rating(fingerprint).has_value());
+        // Apply a mix of wins and draws, and compare with the full rating.
+        RatingGame expected;
+        for (std::size_t turn = 0; turn < 40; ++turn) {
+            const auto winner = (turn % 5 == 4) ? std::nullopt : std::optional<Player>{Player{static_cast<uint8_t>(turn % 4)}};
+            const auto adjustment = RatingAdjustment{turn, Player{static_cast<uint8_t>(turn % 3)}, 40, winner};
+            expected.applyAdjustment(adjustment);
+            table.applyAdjustment(fingerprint, adjustment);
+        }
+        REQUIRE(table.size() == 1);
+        const auto rating = table.rating(fingerprint);
+        REQUIRE(rating.has_value());
+        REQUIRE(rating->ratingCount() == expected.ratingCount());
+        REQUIRE(rating->draws() == expected.draws());
+        for (std::size_t i = 0; i < Player::count; ++i) {
+            REQUIRE(rating->rating(i).win() == expected.rating(i).win());
+            REQUIRE(std::abs(rating->rating(i).loss() - expected.rating(i).loss()) < 1e-9);
+            REQUIRE(std::abs(rating->rating(i).combined() - expected.rating(i).combined()) < 1e-4);
+        }
+    }
+
+    void testPrecision() {
+        const auto fingerprint = StateFingerprint{1, 2};
+        // A frequent state with a large sum, that is adjusted by many draws.
+        StateRatingRecord largeRecord{};
+        largeRecord.ratingCount = 1;
+        largeRecord.combined.fill(1'000'000.0);
+        const auto draw = RatingAdjustment{std::nullopt};
+        StateRatingTable table;
+        StateRatingTable compactTable{RatingPrecision::Float};
+        REQUIRE(compactTable.precision() == RatingPrecision::Float);
+        for (auto *currentTable : {&table, &compactTable}) {
+            currentTable->addRecord(fingerprint, largeRecord);
+            for (int i = 0; i < 1'000; ++i) {
+                currentTable->applyAdjustment(fingerprint, draw);
+            }
+        }
+        const auto expected = 1'000'000.0 + 1'000.0 * draw.rating(0).combined();
+        REQUIRE(std::abs(table.rating(fingerprint)->rating(0).combined() - expected) < 1e-6);
+        // The 32-bit floats lose the draws, but keep all counters exact.
+        const auto compactRating = compactTable.rating(fingerprint);
+        REQUIRE(compactRating->ratingCount() == 1'001);
+        REQUIRE(std::abs(compactRating->rating(0).combined() - expected) > 1.0);
+        REQUIRE(compactTable.memoryUse() < table.memoryUse());
+    }
+
+    void testGrowAndReserve() {
+        const auto adjustment = RatingAdjustment{std::optional<Player>{Player{1}}};
+        StateRatingTable table;
+        for (uint64_t i = 0; i < 10'000; ++i) {
+            table.applyAdjustment(StateFingerprint{zobrist::mix(i), zobrist::mix(i + 1'000'000)}, adjustment);
+        }
+        REQUIRE(table.size() == 10'000);
+        REQUIRE(table.slotCount() * 3 >= table.size() * 4);
+        for (uint64_t i = 0; i < 10'000; ++i) {
+            const auto rating = table.rating(StateFingerprint{zobrist::mix(i), zobrist::mix(i + 1'000'000)});
+            REQUIRE(rating.has_value());
+            REQUIRE(rating->ratingCount() == 1);
+        }
+        // Fingerprints only differing in one half are different states.
+        REQUIRE_FALSE(table.rating(StateFingerprint{zobrist::mix(0), zobrist::mix(1)}).has_value());
+        // 12'289 records need just more than 2^14 slots at a load of 3/4.
+        for (const std::size_t recordCount : {std::size_t{10'000}, std::size_t{12'289}}) {
+            StateRatingTable reservedTable;
+            reservedTable.reserve(recordCount);
+            const auto slotCount = reservedTable.slotCount();
+            for (uint64_t i = 0; i < recordCount; ++i) {
+                reservedTable.applyAdjustment(StateFingerprint{i, zobrist::mix(i)}, adjustment);
+            }
+            REQUIRE(reservedTable.size() == recordCount);
+            REQUIRE(reservedTable.slotCount() == slotCount);
+            REQUIRE(reservedTable.slotCount() * 3 >= reservedTable.size() * 4);
+            REQUIRE(reservedTable.memoryUse() <= recordCount * (StateRatingTable::bytesPerRecord(RatingPrecision::Double) + 6));
+            for (uint64_t i = 0; i < recordCount; ++i) {
+                REQUIRE(reservedTable.rating(StateFingerprint{i, zobrist::mix(i)}).has_value());
+            }
+        }
+    }
+};
+
@@ -0,0 +1,96 @@
+// Copyright (c) 2025 Metikumi. https://metikumi.com
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+
+#include <erbsland/unittest/UnitTest.hpp>
+
+#include "TaskScheduler.hpp"
+
+#include <atomic>
+#include <vector>
+
+
+class TaskSchedulerTest : public el::UnitTest {
+public:
+    void testAllTasksRunOnce() {
+        constexpr std::size_t taskCount = 1000;
+        std::vector<std::atomic_int> runCounts(taskCount);
+        {
+            TaskScheduler scheduler{4};
+            REQUIRE(scheduler.workerCount() == 4);
+            for (std::size_t i = 0; i < taskCount; ++i) {
+                scheduler.submit([&runCounts, i]() { runCounts[i] += 1; });
+            }
+            scheduler.waitForIdle();
+            REQUIRE(scheduler.pendingCount() == 0);
+        }
+        for (const auto &runCount : runCounts) {
+            REQUIRE(runCount == 1);
+        }
+    }
+
+    void testTasksSubmitTasks() {
+        // Chains of tasks, where each task schedules its successor, like the games in the simulation.
+        constexpr std::size_t chainCount = 8;
+        constexpr std::size_t chainLength = 100;
+        std::atomic_size_t runCount{0};
+        TaskScheduler scheduler{3};
+        std::function<void(std::size_t)> runChain = [&](const std::size_t remaining) {
+            runCount += 1;
+            if (remaining > 1) {
+                scheduler.submit([&runChain, remaining]() { runChain(remaining - 1); });
+            }
+        };
+        for (std::size_t i = 0; i < chainCount; ++i) {
+            scheduler.submit([&runChain]() { runChain(chainLength); });
+        }
+        scheduler.waitForIdle();
+        REQUIRE(runCount == chainCount * chainLength);
+    }
+
+    void testTaskGroup() {
+        TaskScheduler scheduler{2};
+        std::atomic_size_t outerCount{0};
+        std::atomic_size_t innerCount{0};
+        std::atomic_bool allInnerFinished{true};
+        for (std::size_t i = 0; i < 16; ++i) {
+            scheduler.submit([&]() {
+                std::atomic_size_t localCount{0};
+                {
+                    TaskGroup group{*TaskScheduler::current()};
+                    for (std::size_t j = 0; j < 10; ++j) {
+                        group.run([&]() {
+                            localCount += 1;
+                            innerCount += 1;
+                        });
+                    }
+                    group.wait();
+                    if (localCount != 10) {
+                        allInnerFinished = false;
+                    }
+                }
+                outerCount += 1;
+            });
+        }
+        scheduler.waitForIdle();
+        REQUIRE(outerCount == 16);
+        REQUIRE(innerCount == 160);
+        REQUIRE(allInnerFinished);
+    }
+
+    void testCurrentWorker() {
+        REQUIRE(TaskScheduler::current() == nullptr);
+        REQUIRE(TaskScheduler::currentWorkerIndex() == TaskScheduler::noWorker);
+        TaskScheduler scheduler{2};
+        std::atomic_bool isCurrent{false};
+        std::atomic_size_t workerIndex{TaskScheduler::noWorker};
+        scheduler.submit([&]() {
+            isCurrent = (TaskScheduler::current() == &scheduler);
+            workerIndex = TaskScheduler::currentWorkerIndex();
+        });
+        scheduler.waitForIdle();
+        REQUIRE(isCurrent);
+        REQUIRE(workerIndex < 2);
+    }
+};
+
@@ -4,8 +4,12 @@
 
 #include <erbsland/unittest/UnitTest.hpp>
 
+#include "RollingAverage.hpp"
 #include "Utilities.hpp"
 
+#include <random>
+#include <vector>
+
 
 class UtilitiesTest : public el::UnitTest {
 public:
@@ -25,6 +29,54 @@ public:
         size = utility::sizeUTF8("ab⬛");
         REQUIRE(size == 3);
     }
+
+    void testRollingAverage() {
+        RollingAverage<double, 4> average;
+        REQUIRE(average.count() == 0);
+        REQUIRE(average.average() == 0.0);
+        average.add(2.0);
+        REQUIRE(average.average() == 2.0);
+        average.add(4.0);
+        average.add(6.0);
+        average.add(8.0);
+        REQUIRE(average.count() == 4);
+        REQUIRE(average.average() == 5.0);
+        average.add(10.0); // replaces 2.0
+        REQUIRE(average.count() == 4);
+        REQUIRE(average.average() == 7.0);
+        for (int i = 0; i < 10; ++i) {
+            average.add(1.0);
+        }
+        REQUIRE(average.average() == 1.0);
+    }
+
+    void testDeriveSeed() {
+        // The derived seeds only depend on the seed and the index.
+        REQUIRE(utility::deriveSeed(42, 0) == utility::deriveSeed(42, 0));
+        REQUIRE(utility::deriveSeed(42, 0) != utility::deriveSeed(42, 1));
+        REQUIRE(utility::deriveSeed(42, 0) != utility::deriveSeed(43, 0));
+        for (uint64_t index = 0; index < 1000; ++index) {
+            REQUIRE(utility::deriveSeed(0, index) != 0);
+        }
+    }
+
+    void testSeedSequence() {
+        // Must generate the same values as `std::seed_seq`, so seeded games do not change.
+        for (const uint64_t seed : {uint64_t{1}, uint64_t{42}, utility::deriveSeed(7, 3)}) {
+            const auto first = static_cast<uint32_t>(seed);
+            const auto second = static_cast<uint32_t>(seed >> 32U);
+            for (const std::size_t size : {std::size_t{1}, std::size_t{3}, std::size_t{10}, std::size_t{100}, std::size_t{624}}) {
+                std::vector<uint32_t> expected(size);
+                std::seed_seq{first, second}.generate(expected.begin(), expected.end());
+                std::vector<uint32_t> actual(size);
+                utility::SeedSequence{first, second}.generate(actual.begin(), actual.end());
+                REQUIRE(actual == expected);
+            }
+            std::seed_seq expectedSequence{first, second};
+            utility::SeedSequence sequence{first, second};
+            REQUIRE(std::mt19937{expectedSequence}() == std::mt19937{sequence}());
+        }
+    }
 };
 
 